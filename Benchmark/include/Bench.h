@@ -0,0 +1,87 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * Minimal microbenchmark harness. Every benchmark runs a single operation in a loop, the
+ * iteration count being calibrated so that each of its repetitions lasts about
+ * minTime / repetitions. The reported time is the median of the repetitions, allocations
+ * are counted by the replaced global operator new (see AllocationCounter.cpp).
+ */
+
+struct AllocationCounts
+{
+	std::uint64_t allocations;
+	std::uint64_t bytes;
+};
+
+// Allocations made by the process so far.
+AllocationCounts currentAllocationCounts();
+
+// Keeps the compiler from optimizing value (and what computed it) away.
+template <typename T>
+inline void doNotOptimize(const T& value)
+{
+#if defined(__GNUC__)
+	asm volatile("" : : "r,m"(value) : "memory");
+#else
+	static volatile const void* sink;
+	sink = &value;
+#endif
+}
+
+struct BenchOptions
+{
+	std::string filter;
+	std::chrono::milliseconds minTime{500};
+	unsigned int repetitions = 5;
+};
+
+struct BenchResult
+{
+	std::string name;
+	std::uint64_t iterations;
+	double nsPerOp;
+	double allocationsPerOp;
+	double bytesPerOp;
+};
+
+class BenchSuite
+{
+public:
+	// op is invoked once per iteration, its result should go through doNotOptimize.
+	template <typename Op>
+	void add(std::string name, Op op)
+	{
+		benchmarks.push_back(Benchmark{std::move(name), [op = std::move(op)](std::uint64_t iterations) mutable {
+			for (std::uint64_t i = 0; i < iterations; ++i) {
+				op();
+			}
+		}});
+	}
+
+	// Runs the benchmarks whose name contains options.filter, reporting each result as it completes.
+	std::vector<BenchResult> run(const BenchOptions& options, const std::function<void(const BenchResult&)>& onResult) const;
+
+private:
+	struct Benchmark
+	{
+		std::string name;
+		std::function<void(std::uint64_t)> loop;
+	};
+
+	std::vector<Benchmark> benchmarks;
+};
+
+void registerGenericBenchmarks(BenchSuite& suite);
+void registerHandlerBenchmarks(BenchSuite& suite);
+void registerJSONBenchmarks(BenchSuite& suite);
+void registerQueryStringBenchmarks(BenchSuite& suite);
+
+#endif
@@ -0,0 +1,84 @@
+#ifndef FIXTURES_H
+#define FIXTURES_H
+
+#include <boost/beast/http.hpp>
+#include <cstddef>
+#include <initializer_list>
+#include "JSONObject.hpp"
+#include "JSONSerializer.hpp"
+#include "JSONValidator.hpp"
+#include <optional>
+#include "QueryStringSerializer.hpp"
+#include "QueryStringValidator.hpp"
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+// Types and payloads shared by the benchmarks, modeled after the Example's.
+
+struct Address
+{
+	int number;
+	std::string street;
+};
+
+struct Customer
+{
+	std::string firstName;
+	std::string lastName;
+	Address address;
+};
+
+template <>
+struct JSONObject<Address>
+{
+	constexpr static auto fields = std::make_tuple(
+		JSONField("number", &Address::number),
+		JSONField("street", &Address::street)
+	);
+};
+
+template <>
+struct JSONObject<Customer>
+{
+	constexpr static auto fields = std::make_tuple(
+		JSONField("firstName", &Customer::firstName),
+		JSONField("lastName", &Customer::lastName),
+		JSONField("address", &Customer::address)
+	);
+};
+
+template <>
+std::optional<Address> ValidateQueryString<Address>(const QueryString& queryString);
+template <>
+std::optional<Customer> ValidateQueryString<Customer>(const QueryString& queryString);
+template <>
+std::optional<Address> ValidateJSON<Address>(const rapidjson::Value& json);
+template <>
+std::optional<Customer> ValidateJSON<Customer>(const rapidjson::Value& json);
+template <>
+rapidjson::Value SerializeJSON<Address>(const Address& v, rapidjson::Document::AllocatorType& allocator);
+template <>
+rapidjson::Value SerializeJSON<Customer>(const Customer& v, rapidjson::Document::AllocatorType& allocator);
+template <>
+QueryStringBuffer SerializeQueryString<Address>(const Address& v);
+template <>
+QueryStringBuffer SerializeQueryString<Customer>(const Customer& v);
+
+using BenchRequest = boost::beast::http::request<boost::beast::http::string_body>;
+
+Customer makeCustomer(std::size_t seed = 0);
+std::vector<Customer> makeCustomers(std::size_t count);
+
+// x-www-form-urlencoded customer, with a nested and escaped address
+std::string customerQueryString();
+// JSON customer, about 120 bytes
+std::string customerJSON();
+// JSON array of count customers, about 100 bytes each
+std::string customersJSON(std::size_t count);
+
+BenchRequest makeRequest(boost::beast::http::verb verb, std::string_view target, std::string body, std::initializer_list<std::pair<std::string_view, std::string_view>> headers = {});
+
+#endif
@@ -0,0 +1,44 @@
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Log-linear histogram of durations in nanoseconds, in the spirit of HdrHistogram :
+ * each power of two is split in 64 buckets, so that any recorded value is known within
+ * 1.6% whatever its magnitude, at a fixed memory cost and without any allocation.
+ */
+class LatencyHistogram
+{
+public:
+	void record(std::chrono::nanoseconds value);
+	void merge(const LatencyHistogram& other);
+
+	std::uint64_t count() const
+	{
+		return total;
+	}
+
+	// Highest value of the bucket holding the given percentile, in [0, 100].
+	std::chrono::nanoseconds percentile(double p) const;
+	std::chrono::nanoseconds max() const;
+	std::chrono::nanoseconds mean() const;
+
+private:
+	constexpr static unsigned int subBucketBits = 6;
+	constexpr static std::size_t subBucketCount = std::size_t{1} << subBucketBits;
+	constexpr static std::size_t bucketCount = 2 * subBucketCount + (64 - subBucketBits - 1) * subBucketCount;
+
+	static std::size_t indexOf(std::uint64_t value);
+	static std::uint64_t highestValueOf(std::size_t index);
+
+	std::array<std::uint64_t, bucketCount> buckets{};
+	std::uint64_t total = 0;
+	std::uint64_t sum = 0;
+	std::uint64_t highest = 0;
+};
+
+#endif
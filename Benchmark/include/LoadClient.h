@@ -0,0 +1,50 @@
+#ifndef LOAD_CLIENT_H
+#define LOAD_CLIENT_H
+
+#include <boost/asio/ip/tcp.hpp>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include "Fixtures.h"
+#include "LatencyHistogram.h"
+
+/**
+ * HTTP load generator sending the same request over keep-alive connections.
+ *
+ * With a rate, requests are sent on a fixed schedule (open loop) : each connection sends
+ * its share of the rate at regular intervals, and latencies are measured from the time a
+ * request was due rather than from the time it was sent. A server falling behind therefore
+ * shows in the latencies instead of silently lowering the offered load, which is the
+ * coordinated omission of closed-loop generators. Without a rate, each connection sends
+ * its next request as soon as the previous response arrives (closed loop). Connections may
+ * pipeline their requests : each send is then made of several requests written at once,
+ * whose responses are read in order, and every response is measured from the send.
+ */
+
+struct LoadOptions
+{
+	boost::asio::ip::tcp::endpoint endpoint;
+	std::size_t connections = 16;
+	std::size_t threads = 1;
+	// Requests per second over all connections, 0 for a closed loop.
+	double rate = 0;
+	// Requests written together before reading their responses, with a rate each due send writes as many.
+	std::size_t pipeline = 1;
+	std::chrono::steady_clock::duration warmup = std::chrono::seconds{2};
+	std::chrono::steady_clock::duration duration = std::chrono::seconds{10};
+};
+
+struct LoadReport
+{
+	LatencyHistogram latencies;
+	// Requests due during the measured duration which completed with a 2xx status.
+	std::uint64_t succeeded = 0;
+	std::uint64_t failedStatus = 0;
+	std::uint64_t errors = 0;
+	std::chrono::steady_clock::duration elapsed{};
+};
+
+// Blocks until the warmup and the measured duration are over, and every connection is done.
+LoadReport runLoad(const LoadOptions& options, const BenchRequest& request);
+
+#endif
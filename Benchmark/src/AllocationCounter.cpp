@@ -0,0 +1,100 @@
+#include <atomic>
+#include "Bench.h"
+#include <cstdlib>
+#include <new>
+
+// Every allocation of the benchmark goes through these replacements, so that ops can be
+// measured in allocations and bytes as well as in time.
+
+namespace
+{
+	std::atomic<std::uint64_t> allocationCount{0};
+	std::atomic<std::uint64_t> allocatedBytes{0};
+
+	void* allocate(std::size_t size)
+	{
+		allocationCount.fetch_add(1, std::memory_order_relaxed);
+		allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+		if (void* p = std::malloc(size == 0 ? 1 : size)) {
+			return p;
+		}
+		throw std::bad_alloc{};
+	}
+
+	void* allocateAligned(std::size_t size, std::align_val_t alignment)
+	{
+		allocationCount.fetch_add(1, std::memory_order_relaxed);
+		allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+		const auto align = static_cast<std::size_t>(alignment);
+		// aligned_alloc requires a size which is a multiple of the alignment.
+		if (void* p = std::aligned_alloc(align, (size + align - 1) / align * align)) {
+			return p;
+		}
+		throw std::bad_alloc{};
+	}
+}
+
+AllocationCounts currentAllocationCounts()
+{
+	return AllocationCounts{allocationCount.load(std::memory_order_relaxed), allocatedBytes.load(std::memory_order_relaxed)};
+}
+
+void* operator new(std::size_t size)
+{
+	return allocate(size);
+}
+
+void* operator new[](std::size_t size)
+{
+	return allocate(size);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+	return allocateAligned(size, alignment);
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment)
+{
+	return allocateAligned(size, alignment);
+}
+
+void operator delete(void* p) noexcept
+{
+	std::free(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+	std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+	std::free(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept
+{
+	std::free(p);
+}
+
+void operator delete(void* p, std::align_val_t) noexcept
+{
+	std::free(p);
+}
+
+void operator delete[](void* p, std::align_val_t) noexcept
+{
+	std::free(p);
+}
+
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept
+{
+	std::free(p);
+}
+
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept
+{
+	std::free(p);
+}
@@ -0,0 +1,60 @@
+#include "Bench.h"
+#include <algorithm>
+
+namespace
+{
+	using clock_type = std::chrono::steady_clock;
+
+	std::chrono::nanoseconds timeLoop(const std::function<void(std::uint64_t)>& loop, std::uint64_t iterations)
+	{
+		const auto start = clock_type::now();
+		loop(iterations);
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(clock_type::now() - start);
+	}
+
+	// Doubles the iteration count until a loop lasts long enough for the clock's resolution not to matter.
+	std::uint64_t calibrate(const std::function<void(std::uint64_t)>& loop, std::chrono::nanoseconds target)
+	{
+		std::uint64_t iterations = 1;
+		for (;;) {
+			const auto elapsed = timeLoop(loop, iterations);
+			if (elapsed >= target / 4 || iterations >= (std::uint64_t{1} << 40)) {
+				const auto perOp = std::max<std::int64_t>(1, elapsed.count() / static_cast<std::int64_t>(iterations));
+				return std::max<std::uint64_t>(1, static_cast<std::uint64_t>(target.count() / perOp));
+			}
+			iterations *= 2;
+		}
+	}
+}
+
+std::vector<BenchResult> BenchSuite::run(const BenchOptions& options, const std::function<void(const BenchResult&)>& onResult) const
+{
+	std::vector<BenchResult> results;
+	const unsigned int repetitions = std::max(1u, options.repetitions);
+	const auto target = std::chrono::duration_cast<std::chrono::nanoseconds>(options.minTime) / repetitions;
+	for (const auto& benchmark : benchmarks) {
+		if (benchmark.name.find(options.filter) == std::string::npos) {
+			continue;
+		}
+		// The first run also warms up caches and the library's per-thread pools.
+		const auto iterations = calibrate(benchmark.loop, target);
+		std::vector<double> timings;
+		timings.reserve(repetitions);
+		const auto before = currentAllocationCounts();
+		for (unsigned int i = 0; i < repetitions; ++i) {
+			timings.push_back(static_cast<double>(timeLoop(benchmark.loop, iterations).count()) / static_cast<double>(iterations));
+		}
+		const auto after = currentAllocationCounts();
+		std::nth_element(timings.begin(), timings.begin() + timings.size() / 2, timings.end());
+		const auto totalOps = static_cast<double>(iterations) * repetitions;
+		results.push_back(BenchResult{
+			benchmark.name,
+			iterations,
+			timings[timings.size() / 2],
+			static_cast<double>(after.allocations - before.allocations) / totalOps,
+			static_cast<double>(after.bytes - before.bytes) / totalOps
+		});
+		onResult(results.back());
+	}
+	return results;
+}
@@ -0,0 +1,142 @@
+#include "Fixtures.h"
+#include "GenericSerializer.hpp"
+
+template <>
+std::optional<Address> ValidateQueryString<Address>(const QueryString& queryString)
+{
+	auto numberOpt = ValidateQueryString<int>(queryString, "number");
+	auto streetOpt = ValidateQueryString<std::string>(queryString, "street");
+	if (numberOpt && streetOpt) {
+		return Address{*numberOpt, *streetOpt};
+	}
+	return std::nullopt;
+}
+
+template <>
+std::optional<Customer> ValidateQueryString<Customer>(const QueryString& queryString)
+{
+	auto firstNameOpt = ValidateQueryString<std::string>(queryString, "firstName");
+	auto lastNameOpt = ValidateQueryString<std::string>(queryString, "lastName");
+	auto addressOpt = ValidateQueryString<Address>(queryString, "address", QueryStringValidator<Address>{});
+	if (firstNameOpt && lastNameOpt && addressOpt) {
+		return Customer{*firstNameOpt, *lastNameOpt, *addressOpt};
+	}
+	return std::nullopt;
+}
+
+template <>
+std::optional<Address> ValidateJSON<Address>(const rapidjson::Value& json)
+{
+	auto numberOpt = ValidateJSON<int>(json, "number");
+	auto streetOpt = ValidateJSON<std::string>(json, "street");
+	if (numberOpt && streetOpt) {
+		return Address{*numberOpt, *streetOpt};
+	}
+	return std::nullopt;
+}
+
+template <>
+std::optional<Customer> ValidateJSON<Customer>(const rapidjson::Value& json)
+{
+	auto firstNameOpt = ValidateJSON<std::string>(json, "firstName");
+	auto lastNameOpt = ValidateJSON<std::string>(json, "lastName");
+	auto addressOpt = ValidateJSON<Address>(json, "address");
+	if (firstNameOpt && lastNameOpt && addressOpt) {
+		return Customer{*firstNameOpt, *lastNameOpt, *addressOpt};
+	}
+	return std::nullopt;
+}
+
+template <>
+rapidjson::Value SerializeJSON<Address>(const Address& v, rapidjson::Document::AllocatorType& allocator)
+{
+	rapidjson::Value element{rapidjson::kObjectType};
+	element.AddMember("number", SerializeJSON(v.number, allocator), allocator);
+	element.AddMember("street", SerializeJSON(v.street, allocator), allocator);
+	return element;
+}
+
+template <>
+rapidjson::Value SerializeJSON<Customer>(const Customer& v, rapidjson::Document::AllocatorType& allocator)
+{
+	rapidjson::Value element{rapidjson::kObjectType};
+	element.AddMember("firstName", SerializeJSON(v.firstName, allocator), allocator);
+	element.AddMember("lastName", SerializeJSON(v.lastName, allocator), allocator);
+	element.AddMember("address", SerializeJSON(v.address, allocator), allocator);
+	return element;
+}
+
+template <>
+QueryStringBuffer SerializeQueryString<Address>(const Address& v)
+{
+	return QueryStringBuffer{std::initializer_list<QueryStringBuffer::value_type>{
+		{"number", GenericSerialize(v.number)},
+		{"street", GenericSerialize(v.street)}
+	}};
+}
+
+template <>
+QueryStringBuffer SerializeQueryString<Customer>(const Customer& v)
+{
+	return QueryStringBuffer{std::initializer_list<QueryStringBuffer::value_type>{
+		{"firstName", GenericSerialize(v.firstName)},
+		{"lastName", GenericSerialize(v.lastName)},
+		{"address", QueryStringSerializer<Address>{}(v.address)}
+	}};
+}
+
+Customer makeCustomer(std::size_t seed)
+{
+	return Customer{
+		"Gabriel" + std::to_string(seed),
+		"Aubut-Lussier",
+		Address{static_cast<int>(25 + seed), "C++ Montréal, suite " + std::to_string(seed)}
+	};
+}
+
+std::vector<Customer> makeCustomers(std::size_t count)
+{
+	std::vector<Customer> customers;
+	customers.reserve(count);
+	for (std::size_t i = 0; i < count; ++i) {
+		customers.push_back(makeCustomer(i));
+	}
+	return customers;
+}
+
+std::string customerQueryString()
+{
+	return "firstName=Gabriel&lastName=Aubut-Lussier&address=number%3D25%26street%3DC%252B%252B%2520Montr%25C3%25A9al";
+}
+
+std::string customerJSON()
+{
+	return R"({"firstName":"Gabriel","lastName":"Aubut-Lussier","address":{"number":25,"street":"C++ Montréal"}})";
+}
+
+std::string customersJSON(std::size_t count)
+{
+	std::string json = "[";
+	for (std::size_t i = 0; i < count; ++i) {
+		if (i != 0) {
+			json += ',';
+		}
+		json += R"({"firstName":"Gabriel)" + std::to_string(i) + R"(","lastName":"Aubut-Lussier","address":{"number":)" + std::to_string(25 + i) + R"(,"street":"C++ Montréal"}})";
+	}
+	json += ']';
+	return json;
+}
+
+BenchRequest makeRequest(boost::beast::http::verb verb, std::string_view target, std::string body, std::initializer_list<std::pair<std::string_view, std::string_view>> headers)
+{
+	BenchRequest req{verb, boost::beast::string_view{target.data(), target.size()}, 11};
+	req.set(boost::beast::http::field::host, "127.0.0.1:8080");
+	req.set(boost::beast::http::field::user_agent, "SecureRequestHandler_bench");
+	req.set(boost::beast::http::field::accept, "*/*");
+	for (const auto& header : headers) {
+		req.set(boost::beast::string_view{header.first.data(), header.first.size()}, boost::beast::string_view{header.second.data(), header.second.size()});
+	}
+	req.body() = std::move(body);
+	req.prepare_payload();
+	return req;
+}
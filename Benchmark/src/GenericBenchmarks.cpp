@@ -0,0 +1,39 @@
+#include "Bench.h"
+#include "GenericSerializer.hpp"
+#include "GenericValidator.hpp"
+#include <string>
+#include <string_view>
+
+namespace
+{
+	template <typename T>
+	void addGenericCase(BenchSuite& suite, const std::string& typeName, std::string_view input, T value)
+	{
+		suite.add("GenericValidate<" + typeName + ">", [input]() {
+			doNotOptimize(GenericValidate<T>(input));
+		});
+		suite.add("GenericSerialize<" + typeName + ">", [value]() {
+			doNotOptimize(GenericSerialize<T>(value));
+		});
+		suite.add("GenericSerializeInto<" + typeName + ">", [value, out = std::string{}]() mutable {
+			out.clear();
+			GenericSerializeInto<T>(out, value);
+			doNotOptimize(out);
+		});
+	}
+}
+
+void registerGenericBenchmarks(BenchSuite& suite)
+{
+	addGenericCase<int>(suite, "int", "-1234567", -1234567);
+	addGenericCase<long>(suite, "long", "-123456789012", -123456789012l);
+	addGenericCase<long long>(suite, "long long", "-123456789012345", -123456789012345ll);
+	addGenericCase<unsigned int>(suite, "unsigned int", "3456789012", 3456789012u);
+	addGenericCase<unsigned long>(suite, "unsigned long", "12345678901234", 12345678901234ul);
+	addGenericCase<unsigned long long>(suite, "unsigned long long", "18446744073709551615", 18446744073709551615ull);
+	addGenericCase<float>(suite, "float", "3.1415927", 3.1415927f);
+	addGenericCase<double>(suite, "double", "2.718281828459045", 2.718281828459045);
+	addGenericCase<long double>(suite, "long double", "1.4142135623730950488", 1.4142135623730950488l);
+	addGenericCase<std::string>(suite, "std::string", "Aubut-Lussier", std::string{"Aubut-Lussier"});
+	addGenericCase<std::string_view>(suite, "std::string_view", "Aubut-Lussier", std::string_view{"Aubut-Lussier"});
+}
@@ -0,0 +1,158 @@
+#include "BeastRequestAdapter.hpp"
+#include "Bench.h"
+#include "Fixtures.h"
+#include <functional>
+#include <memory>
+#include "ResponseCache.hpp"
+#include "Router.hpp"
+#include "SecureRequestHandler.hpp"
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+// Whole requests going through RequestHandler::operator(), from the validation of the
+// inputs to the serialization of the response. Requests are built once and handed over
+// as const, so that every iteration sees the same input.
+
+namespace
+{
+	template <typename Handler>
+	void addHandlerCase(BenchSuite& suite, std::string name, Handler handler, BenchRequest request)
+	{
+		suite.add(std::move(name), [handler = std::move(handler), request = std::make_shared<const BenchRequest>(std::move(request))]() {
+			doNotOptimize(handler(*request));
+		});
+	}
+
+	using HeaderInputs = std::tuple<
+		InputDesc<std::string_view, HeaderParam<typestring_is("host")>>,
+		InputDesc<std::string_view, HeaderParam<typestring_is("user-agent")>>,
+		InputDesc<std::string_view, HeaderParam<typestring_is("accept")>>,
+		InputDesc<std::string_view, HeaderParam<typestring_is("x-request-id")>>,
+		InputDesc<std::string_view, HeaderParam<typestring_is("x-tenant")>>,
+		InputDesc<int, HeaderParam<typestring_is("x-api-version")>>
+	>;
+
+	template <typename ... Inputs>
+	auto makeHeadersHandler(std::tuple<Inputs...>)
+	{
+		return BeastRequestHandler<OutputDesc<std::string>, Inputs...>{
+			[](auto makeResponse, std::string_view host, auto&&...) {
+				return makeResponse(std::string{host});
+			}
+		};
+	}
+}
+
+void registerHandlerBenchmarks(BenchSuite& suite)
+{
+	BeastRequestHandler<
+		OutputDesc<Customer, JSONStreamSerializer>,
+		InputDesc<Customer, BodyParam, QueryStringValidator>
+	> formHandler{
+		[](auto makeResponse, Customer customer) {
+			return makeResponse(customer);
+		}
+	};
+	addHandlerCase(suite, "RequestHandler/form body", formHandler, makeRequest(boost::beast::http::verb::post, "/customers", customerQueryString(), {
+		{"content-type", "application/x-www-form-urlencoded"}
+	}));
+
+	BeastRequestHandler<
+		OutputDesc<Customer, JSONStreamSerializer>,
+		InputDesc<Customer, QueryStringParam>,
+		InputDesc<std::string_view, PathParam>,
+		InputDesc<std::string_view, VerbParam>
+	> queryHandler{
+		[](auto makeResponse, Customer customer, std::string_view, std::string_view) {
+			return makeResponse(customer);
+		}
+	};
+	addHandlerCase(suite, "RequestHandler/query string", queryHandler, makeRequest(boost::beast::http::verb::get, "/customers?" + customerQueryString(), ""));
+	// Every iteration after the first one is answered from the cache.
+	addHandlerCase(suite, "CachedRequestHandler/query string hit", makeCachedRequestHandler(queryHandler), makeRequest(boost::beast::http::verb::get, "/customers?" + customerQueryString(), ""));
+
+	BeastRequestHandler<
+		ETagOutputDesc<Customer, JSONStreamSerializer>,
+		InputDesc<Customer, QueryStringParam>
+	> taggedHandler{
+		[](auto makeResponse, Customer customer) {
+			return makeResponse(customer);
+		}
+	};
+	// The client already holds the response, it is answered 304 Not Modified.
+	auto revalidation = makeRequest(boost::beast::http::verb::get, "/customers?" + customerQueryString(), "");
+	const auto fullResponse = taggedHandler(revalidation);
+	revalidation.set(boost::beast::http::field::if_none_match, fullResponse[boost::beast::http::field::etag]);
+	addHandlerCase(suite, "RequestHandler/etag not modified", taggedHandler, revalidation);
+	addHandlerCase(suite, "CachedRequestHandler/etag not modified", makeCachedRequestHandler(taggedHandler), revalidation);
+
+	BeastRequestHandler<
+		OutputDesc<Customer, JSONStreamSerializer>,
+		InputDesc<Customer, BodyParam, JSONSAXValidator>
+	> jsonHandler{
+		[](auto makeResponse, Customer customer) {
+			return makeResponse(customer);
+		}
+	};
+	const auto jsonRequest = makeRequest(boost::beast::http::verb::post, "/customers", customerJSON(), {{"content-type", "application/json"}});
+	addHandlerCase(suite, "RequestHandler/json body", jsonHandler, jsonRequest);
+	addHandlerCase(suite, "RequestHandler/invalid json body", jsonHandler, makeRequest(boost::beast::http::verb::post, "/customers", R"({"firstName":"Gabriel","lastName":42})"));
+
+	auto inlineJSONHandler = makeBeastRequestHandler<
+		OutputDesc<Customer, JSONStreamSerializer>,
+		InputDesc<Customer, BodyParam, JSONSAXValidator>
+	>([](auto makeResponse, Customer&& customer) {
+		return makeResponse(customer);
+	});
+	addHandlerCase(suite, "InlineRequestHandler/json body", inlineJSONHandler, jsonRequest);
+
+	BeastRequestHandler<
+		OutputDesc<std::string>,
+		InputDesc<std::vector<Customer>, BodyParam, JSONSAXValidator>
+	> listHandler{
+		[](auto makeResponse, std::vector<Customer> customers) {
+			return makeResponse(std::to_string(customers.size()));
+		}
+	};
+	addHandlerCase(suite, "RequestHandler/json body 64 customers", listHandler, makeRequest(boost::beast::http::verb::post, "/customers", customersJSON(64)));
+
+	addHandlerCase(suite, "RequestHandler/6 headers", makeHeadersHandler(HeaderInputs{}), makeRequest(boost::beast::http::verb::get, "/", "", {
+		{"x-request-id", "6f1c1c1e-0b7a-4c55-8f39-2a3e8f1f6d1e"},
+		{"x-tenant", "montreal"},
+		{"x-api-version", "3"},
+		{"accept-encoding", "gzip, deflate"},
+		{"cookie", "session=0123456789abcdef"}
+	}));
+
+	// Streamed responses are drained batch by batch, as BeastServer would.
+	auto customers = std::make_shared<const std::vector<Customer>>(makeCustomers(64));
+	BeastRequestHandler<StreamedOutputDesc<Customer>> streamHandler{
+		[customers](auto makeResponse) {
+			return makeResponse(std::cref(*customers));
+		}
+	};
+	suite.add("RequestHandler/streamed 64 customers", [streamHandler, request = std::make_shared<const BenchRequest>(makeRequest(boost::beast::http::verb::get, "/customers", "")), batch = std::string{}]() mutable {
+		auto response = streamHandler(*request);
+		do {
+			batch.clear();
+		} while (response.produce(batch));
+		doNotOptimize(batch);
+	});
+
+	using RouteHandler = decltype(queryHandler);
+	Router<
+		Route<typestring_is("GET"), typestring_is("/customers"), RouteHandler>,
+		Route<typestring_is("POST"), typestring_is("/customers"), RouteHandler>,
+		Route<typestring_is("GET"), typestring_is("/customers/search"), RouteHandler>,
+		Route<typestring_is("GET"), typestring_is("/orders"), RouteHandler>,
+		Route<typestring_is("POST"), typestring_is("/orders"), RouteHandler>,
+		Route<typestring_is("GET"), typestring_is("/orders/pending"), RouteHandler>,
+		Route<typestring_is("GET"), typestring_is("/health"), RouteHandler>,
+		Route<typestring_is("GET"), typestring_is("/metrics"), RouteHandler>
+	> router{queryHandler, queryHandler, queryHandler, queryHandler, queryHandler, queryHandler, queryHandler, queryHandler};
+	addHandlerCase(suite, "Router/8 routes", router, makeRequest(boost::beast::http::verb::get, "/orders/pending?" + customerQueryString(), ""));
+	addHandlerCase(suite, "Router/8 routes, not found", router, makeRequest(boost::beast::http::verb::get, "/orders/archived", ""));
+}
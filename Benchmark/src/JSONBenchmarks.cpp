@@ -0,0 +1,91 @@
+#include "BeastRequestAdapter.hpp"
+#include "Bench.h"
+#include "Compression.hpp"
+#include "Fixtures.h"
+#include "JSONSAXValidator.hpp"
+#include <memory>
+#include "RequestContext.hpp"
+#include <string>
+#include <vector>
+
+namespace
+{
+	template <typename T>
+	void addValidateJSONCase(BenchSuite& suite, const std::string& typeName, const std::shared_ptr<rapidjson::Document>& doc, const char* key)
+	{
+		suite.add("ValidateJSON<" + typeName + ">", [doc, key]() {
+			doNotOptimize(ValidateJSON<T>(*doc, key));
+		});
+	}
+}
+
+void registerJSONBenchmarks(BenchSuite& suite)
+{
+	auto scalars = std::make_shared<rapidjson::Document>();
+	scalars->Parse(R"({"bool":true,"int":-1234567,"int64":-123456789012345,"unsigned":3456789012,"uint64":18446744073709551615,"float":3.1415927,"double":2.718281828459045,"string":"Aubut-Lussier"})");
+	addValidateJSONCase<bool>(suite, "bool", scalars, "bool");
+	addValidateJSONCase<int>(suite, "int", scalars, "int");
+	addValidateJSONCase<int64_t>(suite, "int64_t", scalars, "int64");
+	addValidateJSONCase<unsigned int>(suite, "unsigned int", scalars, "unsigned");
+	addValidateJSONCase<uint64_t>(suite, "uint64_t", scalars, "uint64");
+	addValidateJSONCase<float>(suite, "float", scalars, "float");
+	addValidateJSONCase<double>(suite, "double", scalars, "double");
+	addValidateJSONCase<std::string>(suite, "std::string", scalars, "string");
+	addValidateJSONCase<std::string_view>(suite, "std::string_view", scalars, "string");
+
+	const std::string customer = customerJSON();
+	const std::string customers = customersJSON(64);
+	auto customerDoc = std::make_shared<rapidjson::Document>();
+	customerDoc->Parse(customer.data(), customer.size());
+	suite.add("ValidateJSON<Customer>", [customerDoc]() {
+		doNotOptimize(ValidateJSON<Customer>(*customerDoc));
+	});
+	suite.add("JSONValidator<Customer>", [customer]() {
+		doNotOptimize(JSONValidator<Customer>{}(customer));
+	});
+	suite.add("JSONSAXValidator<Customer>", [customer]() {
+		doNotOptimize(JSONSAXValidator<Customer>{}(customer));
+	});
+	suite.add("JSONSAXValidator<std::vector<Customer>>/64", [customers]() {
+		doNotOptimize(JSONSAXValidator<std::vector<Customer>>{}(customers));
+	});
+
+	// The in-situ validators need a context, which copies the body since the request is const.
+	auto request = std::make_shared<BenchRequest>(makeRequest(boost::beast::http::verb::post, "/customers", customer));
+	suite.add("JSONInsituValidator<Customer>", [request]() {
+		RequestContext<BenchRequest> ctx{*request};
+		doNotOptimize(JSONInsituValidator<Customer>{}(ctx.getBody(), ctx));
+	});
+	suite.add("JSONSAXInsituValidator<Customer>", [request]() {
+		RequestContext<BenchRequest> ctx{*request};
+		doNotOptimize(JSONSAXInsituValidator<Customer>{}(ctx.getBody(), ctx));
+	});
+
+	suite.add("JSONSerializer<Customer>", [value = makeCustomer()]() {
+		doNotOptimize(JSONSerializer<Customer>{}(value));
+	});
+	suite.add("JSONSerializer<Customer>/append", [value = makeCustomer(), out = std::string{}]() mutable {
+		out.clear();
+		JSONSerializer<Customer>{}(value, out);
+		doNotOptimize(out);
+	});
+	suite.add("JSONStreamSerializer<Customer>", [value = makeCustomer()]() {
+		doNotOptimize(JSONStreamSerializer<Customer>{}(value));
+	});
+	suite.add("JSONStreamSerializer<Customer>/append", [value = makeCustomer(), out = std::string{}]() mutable {
+		out.clear();
+		JSONStreamSerializer<Customer>{}(value, out);
+		doNotOptimize(out);
+	});
+	suite.add("JSONStreamSerializer<std::vector<Customer>>/64", [value = makeCustomers(64), out = std::string{}]() mutable {
+		out.clear();
+		JSONStreamSerializer<std::vector<Customer>>{}(value, out);
+		doNotOptimize(out);
+	});
+	// The deflate stream comes from the thread's pool, as it does for BeastServer's responses.
+	suite.add("compressBody/gzip 64 customers", [customers, body = std::string{}]() mutable {
+		body = customers;
+		compressBody(body, ContentCoding::gzip, CompressionOptions{}.level);
+		doNotOptimize(body);
+	});
+}
@@ -0,0 +1,69 @@
+#include "LatencyHistogram.h"
+#include <algorithm>
+
+std::size_t LatencyHistogram::indexOf(std::uint64_t value)
+{
+	// Values below 2 * subBucketCount are exact, the others keep their subBucketBits + 1 highest bits.
+	if (value < 2 * subBucketCount) {
+		return static_cast<std::size_t>(value);
+	}
+	const unsigned int highestBit = 63 - static_cast<unsigned int>(__builtin_clzll(value));
+	const unsigned int shift = highestBit - subBucketBits;
+	const auto top = static_cast<std::size_t>(value >> shift);
+	return 2 * subBucketCount + (shift - 1) * subBucketCount + (top - subBucketCount);
+}
+
+std::uint64_t LatencyHistogram::highestValueOf(std::size_t index)
+{
+	if (index < 2 * subBucketCount) {
+		return index;
+	}
+	const auto shift = static_cast<unsigned int>((index - 2 * subBucketCount) / subBucketCount + 1);
+	const std::uint64_t top = (index - 2 * subBucketCount) % subBucketCount + subBucketCount;
+	return ((top + 1) << shift) - 1;
+}
+
+void LatencyHistogram::record(std::chrono::nanoseconds value)
+{
+	const auto ns = static_cast<std::uint64_t>(std::max<std::chrono::nanoseconds::rep>(value.count(), 0));
+	++buckets[indexOf(ns)];
+	++total;
+	sum += ns;
+	highest = std::max(highest, ns);
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other)
+{
+	for (std::size_t i = 0; i < bucketCount; ++i) {
+		buckets[i] += other.buckets[i];
+	}
+	total += other.total;
+	sum += other.sum;
+	highest = std::max(highest, other.highest);
+}
+
+std::chrono::nanoseconds LatencyHistogram::percentile(double p) const
+{
+	if (total == 0) {
+		return std::chrono::nanoseconds{0};
+	}
+	const auto rank = std::max<std::uint64_t>(1, static_cast<std::uint64_t>(static_cast<double>(total) * std::clamp(p, 0.0, 100.0) / 100.0 + 0.5));
+	std::uint64_t seen = 0;
+	for (std::size_t i = 0; i < bucketCount; ++i) {
+		seen += buckets[i];
+		if (seen >= rank) {
+			return std::chrono::nanoseconds{static_cast<std::chrono::nanoseconds::rep>(std::min(highestValueOf(i), highest))};
+		}
+	}
+	return max();
+}
+
+std::chrono::nanoseconds LatencyHistogram::max() const
+{
+	return std::chrono::nanoseconds{static_cast<std::chrono::nanoseconds::rep>(highest)};
+}
+
+std::chrono::nanoseconds LatencyHistogram::mean() const
+{
+	return std::chrono::nanoseconds{total == 0 ? 0 : static_cast<std::chrono::nanoseconds::rep>(sum / total)};
+}
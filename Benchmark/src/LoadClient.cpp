@@ -0,0 +1,207 @@
+#include "LoadClient.h"
+#include <algorithm>
+#include <boost/asio/write.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/http.hpp>
+#include <memory>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	using clock_type = std::chrono::steady_clock;
+
+	// A response which takes longer than this is counted as an error, and its connection given up.
+	constexpr auto responseTimeout = std::chrono::seconds{10};
+
+	struct Schedule
+	{
+		clock_type::time_point measureFrom;
+		clock_type::time_point end;
+		// Between two requests of a connection, none in a closed loop.
+		std::optional<clock_type::duration> interval;
+		std::size_t pipeline = 1;
+	};
+
+	class LoadConnection : public std::enable_shared_from_this<LoadConnection>
+	{
+	public:
+		LoadConnection(boost::asio::io_context& ioc, const BenchRequest& request, const Schedule& schedule, clock_type::time_point firstDue)
+		: stream{ioc}
+		, timer{ioc}
+		, schedule{schedule}
+		, due{firstDue}
+		{
+			std::ostringstream serialized;
+			serialized << request;
+			for (std::size_t i = 0; i < schedule.pipeline; ++i) {
+				requests += serialized.str();
+			}
+		}
+
+		void start(const boost::asio::ip::tcp::endpoint& endpoint)
+		{
+			stream.expires_after(responseTimeout);
+			stream.async_connect(endpoint, boost::beast::bind_front_handler(&LoadConnection::onConnect, shared_from_this()));
+		}
+
+		void collect(LoadReport& report) const
+		{
+			report.latencies.merge(latencies);
+			report.succeeded += succeeded;
+			report.failedStatus += failedStatus;
+			report.errors += errors;
+		}
+
+	private:
+		void onConnect(boost::beast::error_code ec)
+		{
+			if (ec) {
+				return fail();
+			}
+			scheduleNext();
+		}
+
+		void scheduleNext()
+		{
+			if (schedule.interval) {
+				if (due >= schedule.end) {
+					return close();
+				}
+				timer.expires_at(due);
+				timer.async_wait(boost::beast::bind_front_handler(&LoadConnection::doSend, shared_from_this()));
+			} else {
+				due = clock_type::now();
+				if (due >= schedule.end) {
+					return close();
+				}
+				doSend({});
+			}
+		}
+
+		void doSend(boost::beast::error_code ec)
+		{
+			if (ec) {
+				return fail();
+			}
+			stream.expires_after(responseTimeout);
+			boost::asio::async_write(stream, boost::asio::buffer(requests), boost::beast::bind_front_handler(&LoadConnection::onWrite, shared_from_this()));
+		}
+
+		void onWrite(boost::beast::error_code ec, std::size_t)
+		{
+			if (ec) {
+				return fail();
+			}
+			pending = schedule.pipeline;
+			doRead();
+		}
+
+		void doRead()
+		{
+			response = {};
+			boost::beast::http::async_read(stream, buffer, response, boost::beast::bind_front_handler(&LoadConnection::onRead, shared_from_this()));
+		}
+
+		void onRead(boost::beast::error_code ec, std::size_t)
+		{
+			if (ec) {
+				return fail();
+			}
+			// Measured from when the request was due, so that the time spent waiting for a late
+			// response to free the connection is not left out.
+			if (due >= schedule.measureFrom && due < schedule.end) {
+				latencies.record(clock_type::now() - due);
+				if (boost::beast::http::to_status_class(response.result()) == boost::beast::http::status_class::successful) {
+					++succeeded;
+				} else {
+					++failedStatus;
+				}
+			}
+			if (!response.keep_alive()) {
+				return fail();
+			}
+			if (--pending > 0) {
+				return doRead();
+			}
+			if (schedule.interval) {
+				due += *schedule.interval;
+			}
+			scheduleNext();
+		}
+
+		void fail()
+		{
+			++errors;
+			close();
+		}
+
+		void close()
+		{
+			boost::beast::error_code ec;
+			stream.socket().shutdown(boost::asio::ip::tcp::socket::shutdown_both, ec);
+		}
+
+		boost::beast::tcp_stream stream;
+		boost::asio::steady_timer timer;
+		boost::beast::flat_buffer buffer;
+		// The request serialized once, as many times as it is pipelined.
+		std::string requests;
+		std::size_t pending = 0;
+		boost::beast::http::response<boost::beast::http::string_body> response;
+		const Schedule& schedule;
+		clock_type::time_point due;
+		LatencyHistogram latencies;
+		std::uint64_t succeeded = 0;
+		std::uint64_t failedStatus = 0;
+		std::uint64_t errors = 0;
+	};
+}
+
+LoadReport runLoad(const LoadOptions& options, const BenchRequest& request)
+{
+	const std::size_t threadCount = std::max<std::size_t>(options.threads, 1);
+	const std::size_t connectionCount = std::max<std::size_t>(options.connections, 1);
+	std::vector<std::unique_ptr<boost::asio::io_context>> contexts;
+	for (std::size_t i = 0; i < threadCount; ++i) {
+		contexts.push_back(std::make_unique<boost::asio::io_context>(1));
+	}
+
+	const auto start = clock_type::now();
+	Schedule schedule{start + options.warmup, start + options.warmup + options.duration, std::nullopt, std::max<std::size_t>(options.pipeline, 1)};
+	if (options.rate > 0) {
+		schedule.interval = std::chrono::duration_cast<clock_type::duration>(std::chrono::duration<double>{static_cast<double>(connectionCount) / options.rate});
+	}
+
+	std::vector<std::shared_ptr<LoadConnection>> connections;
+	connections.reserve(connectionCount);
+	for (std::size_t i = 0; i < connectionCount; ++i) {
+		// Connections are staggered over an interval so that the requests are evenly spread in time.
+		const auto offset = schedule.interval ? *schedule.interval * static_cast<clock_type::rep>(i) / static_cast<clock_type::rep>(connectionCount) : clock_type::duration{};
+		connections.push_back(std::make_shared<LoadConnection>(*contexts[i % threadCount], request, schedule, start + offset));
+		connections.back()->start(options.endpoint);
+	}
+
+	std::vector<std::thread> threads;
+	for (std::size_t i = 1; i < threadCount; ++i) {
+		threads.emplace_back([&ioc = *contexts[i]] {
+			ioc.run();
+		});
+	}
+	contexts.front()->run();
+	for (auto& thread : threads) {
+		thread.join();
+	}
+
+	LoadReport report;
+	for (const auto& connection : connections) {
+		connection->collect(report);
+	}
+	report.elapsed = options.duration;
+	return report;
+}
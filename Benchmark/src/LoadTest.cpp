@@ -0,0 +1,182 @@
+#include "BeastRequestAdapter.hpp"
+#include "BeastServer.hpp"
+#include <chrono>
+#include <cstdlib>
+#include "Fixtures.h"
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include "LoadClient.h"
+#include "Router.hpp"
+#include "SecureRequestHandler.hpp"
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+
+// Starts a BeastServer on 127.0.0.1 hosting the scenarios' handlers, then drives it with
+// LoadClient and reports throughput and latency percentiles.
+
+namespace
+{
+	struct Scenario
+	{
+		std::string_view name;
+		std::string_view description;
+		std::function<BenchRequest()> makeRequest;
+	};
+
+	const Scenario scenarios[] = {
+		{"hello", "GET /hello, no input and a short text response", [] {
+			return makeRequest(boost::beast::http::verb::get, "/hello", "");
+		}},
+		{"customer-query", "GET /customers with a customer in the query string, echoed as a query string", [] {
+			return makeRequest(boost::beast::http::verb::get, "/customers?" + customerQueryString(), "");
+		}},
+		{"customer-form", "POST /customers with a form-encoded customer, echoed as JSON", [] {
+			return makeRequest(boost::beast::http::verb::post, "/customers", customerQueryString(), {{"content-type", "application/x-www-form-urlencoded"}});
+		}},
+		{"customer-json", "POST /customers/json with a JSON customer, echoed as JSON", [] {
+			return makeRequest(boost::beast::http::verb::post, "/customers/json", customerJSON(), {{"content-type", "application/json"}});
+		}},
+		{"customers-stream", "GET /customers/all, 1000 customers streamed as a JSON array", [] {
+			return makeRequest(boost::beast::http::verb::get, "/customers/all", "");
+		}},
+		{"customers-stream-gzip", "GET /customers/all, 1000 customers streamed as a gzip compressed JSON array", [] {
+			return makeRequest(boost::beast::http::verb::get, "/customers/all", "", {{"accept-encoding", "gzip"}});
+		}},
+	};
+
+	void printUsage(const char* program)
+	{
+		std::cerr << "Usage: " << program << " [--scenario name] [--connections count] [--rate requests/s] [--duration seconds]"
+		<< " [--warmup seconds] [--server-threads count] [--client-threads count] [--pipeline depth]\n"
+		<< "Without a rate, connections send requests back to back (closed loop).\nScenarios:\n";
+		for (const auto& scenario : scenarios) {
+			std::cerr << "  " << std::left << std::setw(23) << scenario.name << scenario.description << '\n';
+		}
+	}
+
+	double toMicroseconds(std::chrono::nanoseconds ns)
+	{
+		return static_cast<double>(ns.count()) / 1000.0;
+	}
+
+	void printReport(const LoadReport& report, const LoadOptions& options)
+	{
+		const double seconds = std::chrono::duration<double>{report.elapsed}.count();
+		std::cout << std::fixed << std::setprecision(1)
+		<< "Requests:   " << report.succeeded << " succeeded, " << report.failedStatus << " non-2xx, " << report.errors << " connection errors\n"
+		<< "Throughput: " << static_cast<double>(report.succeeded + report.failedStatus) / seconds << " requests/s";
+		if (options.rate > 0) {
+			std::cout << " (offered " << options.rate << ")";
+		}
+		std::cout << "\nLatency (us):\n"
+		<< "  mean    " << std::setw(12) << toMicroseconds(report.latencies.mean()) << '\n';
+		const std::pair<const char*, double> percentiles[] = {{"p50", 50.0}, {"p90", 90.0}, {"p99", 99.0}, {"p99.9", 99.9}, {"p99.99", 99.99}};
+		for (const auto& [label, p] : percentiles) {
+			std::cout << "  " << std::left << std::setw(8) << label << std::right << std::setw(12) << toMicroseconds(report.latencies.percentile(p)) << '\n';
+		}
+		std::cout << "  max     " << std::setw(12) << toMicroseconds(report.latencies.max()) << '\n';
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	LoadOptions options;
+	std::string_view scenarioName = "customer-form";
+	std::size_t serverThreads = 1;
+	for (int i = 1; i < argc; ++i) {
+		const std::string_view arg = argv[i];
+		if (i + 1 >= argc) {
+			printUsage(argv[0]);
+			return EXIT_FAILURE;
+		}
+		const char* value = argv[++i];
+		if (arg == "--scenario") {
+			scenarioName = value;
+		} else if (arg == "--connections") {
+			options.connections = static_cast<std::size_t>(std::atol(value));
+		} else if (arg == "--rate") {
+			options.rate = std::atof(value);
+		} else if (arg == "--duration") {
+			options.duration = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>{std::atof(value)});
+		} else if (arg == "--warmup") {
+			options.warmup = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>{std::atof(value)});
+		} else if (arg == "--server-threads") {
+			serverThreads = static_cast<std::size_t>(std::atol(value));
+		} else if (arg == "--client-threads") {
+			options.threads = static_cast<std::size_t>(std::atol(value));
+		} else if (arg == "--pipeline") {
+			options.pipeline = static_cast<std::size_t>(std::atol(value));
+		} else {
+			printUsage(argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+	const Scenario* scenario = nullptr;
+	for (const auto& candidate : scenarios) {
+		if (candidate.name == scenarioName) {
+			scenario = &candidate;
+		}
+	}
+	if (!scenario) {
+		printUsage(argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	BeastRequestHandler<OutputDesc<std::string>> hello{
+		[](auto makeResponse) {
+			return makeResponse(std::string{"Hello, world!\n"});
+		}
+	};
+	BeastRequestHandler<OutputDesc<Customer, QueryStringSerializer>, InputDesc<Customer, QueryStringParam>> customerQuery{
+		[](auto makeResponse, Customer customer) {
+			return makeResponse(customer);
+		}
+	};
+	BeastRequestHandler<OutputDesc<Customer, JSONStreamSerializer>, InputDesc<Customer, BodyParam, QueryStringValidator>> customerForm{
+		[](auto makeResponse, Customer customer) {
+			return makeResponse(customer);
+		}
+	};
+	BeastRequestHandler<OutputDesc<Customer, JSONStreamSerializer>, InputDesc<Customer, BodyParam, JSONSAXValidator>> customerJSONHandler{
+		[](auto makeResponse, Customer customer) {
+			return makeResponse(customer);
+		}
+	};
+	const auto customers = makeCustomers(1000);
+	BeastRequestHandler<StreamedOutputDesc<Customer>> allCustomers{
+		[&customers](auto makeResponse) {
+			return makeResponse(std::cref(customers));
+		}
+	};
+	Router<
+		Route<typestring_is("GET"), typestring_is("/hello"), decltype(hello)>,
+		Route<typestring_is("GET"), typestring_is("/customers"), decltype(customerQuery)>,
+		Route<typestring_is("POST"), typestring_is("/customers"), decltype(customerForm)>,
+		Route<typestring_is("POST"), typestring_is("/customers/json"), decltype(customerJSONHandler)>,
+		Route<typestring_is("GET"), typestring_is("/customers/all"), decltype(allCustomers)>
+	> router{hello, customerQuery, customerForm, customerJSONHandler, allCustomers};
+
+	BeastServer server{router, serverThreads};
+	// Only requests accepting an encoding are compressed.
+	server.setCompression();
+	server.listen({boost::asio::ip::make_address("127.0.0.1"), 0});
+	options.endpoint = server.localEndpoint();
+	std::thread serverThread{[&server] {
+		server.run();
+	}};
+
+	std::cout << "Scenario " << scenario->name << " : " << scenario->description << '\n'
+	<< options.connections << " connections, " << options.threads << " client threads, " << serverThreads << " server threads";
+	if (options.pipeline > 1) {
+		std::cout << ", " << options.pipeline << " pipelined requests";
+	}
+	std::cout << '\n';
+	const auto report = runLoad(options, scenario->makeRequest());
+	server.stop();
+	serverThread.join();
+	printReport(report, options);
+	return report.errors == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
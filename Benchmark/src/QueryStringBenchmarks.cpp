@@ -0,0 +1,61 @@
+#include "Bench.h"
+#include "Fixtures.h"
+#include <string>
+#include <string_view>
+
+void registerQueryStringBenchmarks(BenchSuite& suite)
+{
+	const std::string form = customerQueryString();
+	std::string wideForm;
+	for (int i = 0; i < 32; ++i) {
+		wideForm += (i == 0 ? "" : "&") + std::string{"field"} + std::to_string(i) + "=value" + std::to_string(i);
+	}
+
+	suite.add("getQueryParams/customer", [form, base = QueryStringValidatorBase{}]() {
+		doNotOptimize(base.getQueryParams(form));
+	});
+	suite.add("getQueryParams/32 fields", [wideForm, base = QueryStringValidatorBase{}]() {
+		doNotOptimize(base.getQueryParams(wideForm));
+	});
+
+	suite.add("decodeURIComponent/plain", [buffer = std::string{}]() mutable {
+		doNotOptimize(decodeURIComponent("Aubut-Lussier", buffer));
+	});
+	suite.add("decodeURIComponent/escaped", [buffer = std::string{}]() mutable {
+		doNotOptimize(decodeURIComponent("number%3D25%26street%3DC%252B%252B%2520Montr%25C3%25A9al", buffer));
+	});
+	suite.add("encodeURIComponent/plain", []() {
+		doNotOptimize(encodeURIComponent("Aubut-Lussier"));
+	});
+	suite.add("encodeURIComponent/escaped", []() {
+		doNotOptimize(encodeURIComponent("number=25&street=C++ Montréal"));
+	});
+	suite.add("appendURIComponent/escaped", [out = std::string{}]() mutable {
+		out.clear();
+		appendURIComponent(out, "number=25&street=C++ Montréal");
+		doNotOptimize(out);
+	});
+
+	const auto base = QueryStringValidatorBase{};
+	suite.add("ValidateQueryString<int>", [qs = base.getQueryParams("a=1&b=2&number=25&c=3")]() {
+		doNotOptimize(ValidateQueryString<int>(qs, "number"));
+	});
+	suite.add("ValidateQueryString<std::string>", [qs = base.getQueryParams(form)]() {
+		doNotOptimize(ValidateQueryString<std::string>(qs, "lastName"));
+	});
+	suite.add("ValidateQueryString<Customer>", [qs = base.getQueryParams(form)]() {
+		doNotOptimize(ValidateQueryString<Customer>(qs));
+	});
+	suite.add("QueryStringValidator<Customer>", [form]() {
+		doNotOptimize(QueryStringValidator<Customer>{}(form));
+	});
+
+	suite.add("QueryStringSerializer<Customer>", [customer = makeCustomer()]() {
+		doNotOptimize(QueryStringSerializer<Customer>{}(customer));
+	});
+	suite.add("QueryStringSerializer<Customer>/append", [customer = makeCustomer(), out = std::string{}]() mutable {
+		out.clear();
+		QueryStringSerializer<Customer>{}(customer, out);
+		doNotOptimize(out);
+	});
+}
@@ -0,0 +1,128 @@
+/*
+ * Copyright 2013-present Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * regexGetQueryParams is the Folly-derived implementation getQueryParams had
+ * before the single-pass tokenizer, kept as the reference the tokenizer is checked against.
+ */
+
+#include <boost/regex.hpp>
+#include <cstdlib>
+#include <iostream>
+#include "QueryStringValidator.hpp"
+#include <random>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Compares QueryStringValidatorBase::getQueryParams with the regex it replaced on random
+// query strings. Both must yield the same parameters, as views of the same characters.
+
+namespace
+{
+	std::vector<std::pair<std::string_view, std::string_view>> regexGetQueryParams(std::string_view str)
+	{
+		std::vector<std::pair<std::string_view, std::string_view>> result;
+		if (!str.empty()) {
+			static const boost::regex queryParamRegex(
+				"(^|&)" /*start of query or start of parameter "&"*/
+				"([^=&]*)=?" /*parameter name and "=" if value is expected*/
+				"([^=&]*)" /*parameter value*/
+				"(?=(&|$))" /*forward reference, next should be end of query or start of next parameter*/
+			);
+			const boost::cregex_iterator paramBeginItr(str.data(), str.data() + str.size(), queryParamRegex);
+			boost::cregex_iterator paramEndItr;
+			for (auto itr = paramBeginItr; itr != paramEndItr; ++itr) {
+				if (itr->length(2) == 0) {
+					// key is empty, ignore it
+					continue;
+				}
+				result.emplace_back(
+					std::string_view{(*itr)[2].first, static_cast<std::string_view::size_type>(std::distance((*itr)[2].first, (*itr)[2].second))},
+					std::string_view{(*itr)[3].first, static_cast<std::string_view::size_type>(std::distance((*itr)[3].first, (*itr)[3].second))}
+				);
+			}
+		}
+		return result;
+	}
+
+	bool sameView(std::string_view lhs, std::string_view rhs)
+	{
+		return lhs.data() == rhs.data() && lhs.size() == rhs.size();
+	}
+
+	template <typename Expected, typename Actual>
+	bool sameParams(const Expected& expected, const Actual& actual)
+	{
+		if (expected.size() != actual.size()) {
+			return false;
+		}
+		for (std::size_t i = 0; i < expected.size(); ++i) {
+			if (!sameView(expected[i].first, actual[i].first) || !sameView(expected[i].second, actual[i].second)) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	void printUsage(const char* program)
+	{
+		std::cerr << "Usage: " << program << " [--iterations count] [--seed seed]\n";
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	unsigned long iterations = 200000;
+	unsigned long seed = 42;
+	for (int i = 1; i < argc; ++i) {
+		const std::string_view arg = argv[i];
+		if (i + 1 >= argc) {
+			printUsage(argv[0]);
+			return EXIT_FAILURE;
+		}
+		if (arg == "--iterations") {
+			iterations = std::strtoul(argv[++i], nullptr, 10);
+		} else if (arg == "--seed") {
+			seed = std::strtoul(argv[++i], nullptr, 10);
+		} else {
+			printUsage(argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+
+	// Few distinct characters, so that empty names, empty values and repeated delimiters are frequent.
+	// A raw newline is left out : the regex treats it as a line start, a query string never holds one.
+	constexpr std::string_view alphabet = "ab%+=&";
+	// Strings spanning several blocks of the vectorized scan, and their scalar tail.
+	constexpr std::size_t maxLength = 100;
+	std::mt19937 random{static_cast<std::mt19937::result_type>(seed)};
+	const QueryStringValidatorBase base;
+	std::string query;
+	for (unsigned long iteration = 0; iteration < iterations; ++iteration) {
+		query.resize(random() % maxLength);
+		for (auto& c : query) {
+			c = alphabet[random() % alphabet.size()];
+		}
+		const auto expected = regexGetQueryParams(query);
+		const auto actual = base.getQueryParams(query);
+		if (!sameParams(expected, actual)) {
+			std::cerr << "Mismatch on \"" << query << "\" : the regex yields " << expected.size() << " parameters, the tokenizer " << actual.size() << '\n';
+			return EXIT_FAILURE;
+		}
+	}
+	std::cout << iterations << " query strings parsed alike\n";
+	return EXIT_SUCCESS;
+}
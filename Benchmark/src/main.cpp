@@ -0,0 +1,113 @@
+#include "Bench.h"
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace
+{
+	void printUsage(const char* program)
+	{
+		std::cerr << "Usage: " << program << " [--filter substring] [--min-time milliseconds] [--repetitions count] [--output results.json]\n";
+	}
+
+	void printResult(const BenchResult& result)
+	{
+		std::cout << std::left << std::setw(52) << result.name << std::right
+		<< std::fixed << std::setprecision(1)
+		<< std::setw(12) << result.nsPerOp << " ns/op"
+		<< std::setprecision(2)
+		<< std::setw(10) << result.allocationsPerOp << " allocs/op"
+		<< std::setprecision(1)
+		<< std::setw(12) << result.bytesPerOp << " B/op\n";
+	}
+
+	std::string escapeJSON(std::string_view sv)
+	{
+		std::string result;
+		for (char c : sv) {
+			if (c == '"' || c == '\\') {
+				result += '\\';
+			}
+			result += c;
+		}
+		return result;
+	}
+
+	// One object per benchmark, so that runs can be compared before and after a change.
+	void writeResults(const std::string& path, const BenchOptions& options, const std::vector<BenchResult>& results)
+	{
+		std::ofstream out{path};
+		out << "{\n"
+		<< "  \"context\": {\n"
+#if defined(__VERSION__)
+		<< "    \"compiler\": \"" << escapeJSON(__VERSION__) << "\",\n"
+#endif
+#if defined(__OPTIMIZE__)
+		<< "    \"optimized\": true,\n"
+#else
+		<< "    \"optimized\": false,\n"
+#endif
+		<< "    \"min_time_ms\": " << options.minTime.count() << ",\n"
+		<< "    \"repetitions\": " << options.repetitions << "\n"
+		<< "  },\n"
+		<< "  \"benchmarks\": [";
+		for (std::size_t i = 0; i < results.size(); ++i) {
+			const auto& result = results[i];
+			out << (i == 0 ? "\n" : ",\n")
+			<< "    {\"name\": \"" << escapeJSON(result.name) << "\""
+			<< ", \"iterations\": " << result.iterations
+			<< std::setprecision(3) << std::fixed
+			<< ", \"ns_per_op\": " << result.nsPerOp
+			<< ", \"allocations_per_op\": " << result.allocationsPerOp
+			<< ", \"bytes_per_op\": " << result.bytesPerOp << "}";
+		}
+		out << "\n  ]\n}\n";
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	BenchOptions options;
+	std::string output;
+	for (int i = 1; i < argc; ++i) {
+		const std::string_view arg = argv[i];
+		if (i + 1 >= argc) {
+			printUsage(argv[0]);
+			return EXIT_FAILURE;
+		}
+		if (arg == "--filter") {
+			options.filter = argv[++i];
+		} else if (arg == "--min-time") {
+			options.minTime = std::chrono::milliseconds{std::atol(argv[++i])};
+		} else if (arg == "--repetitions") {
+			options.repetitions = static_cast<unsigned int>(std::atoi(argv[++i]));
+		} else if (arg == "--output") {
+			output = argv[++i];
+		} else {
+			printUsage(argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+
+#if !defined(__OPTIMIZE__)
+	std::cerr << "Warning: the benchmarks were built without optimizations.\n";
+#endif
+
+	BenchSuite suite;
+	registerGenericBenchmarks(suite);
+	registerQueryStringBenchmarks(suite);
+	registerJSONBenchmarks(suite);
+	registerHandlerBenchmarks(suite);
+
+	const auto results = suite.run(options, printResult);
+	if (!output.empty()) {
+		writeResults(output, options, results);
+		std::cout << "Results written to " << output << '\n';
+	}
+	return EXIT_SUCCESS;
+}
@@ -54,6 +54,25 @@ std::optional<CustomerInfo> ValidateJSON<CustomerInfo>(const rapidjson::Value& j
 	return std::nullopt;
 }
 
+template <>
+struct JSONObject<Address>
+{
+	constexpr static auto fields = std::make_tuple(
+		JSONField("number", &Address::number),
+		JSONField("street", &Address::street)
+	);
+};
+
+template <>
+struct JSONObject<CustomerInfo>
+{
+	constexpr static auto fields = std::make_tuple(
+		JSONField("firstName", &CustomerInfo::firstName),
+		JSONField("lastName", &CustomerInfo::lastName),
+		JSONField("address", &CustomerInfo::address)
+	);
+};
+
 template <>
 rapidjson::Value SerializeJSON<Address>(const Address& v, rapidjson::Document::AllocatorType& allocator)
 {
@@ -99,7 +118,7 @@ int main(int argc, char* argv[])
 	BeastRequestHandler<
 		OutputDesc<CustomerInfo, QueryStringSerializer>,
 		InputDesc<std::string_view, HeaderParam<typestring_is("host")>>,
-		InputDesc<CustomerInfo, HeaderParam<typestring_is("customer")>, JSONValidator>,
+		InputDesc<CustomerInfo, HeaderParam<typestring_is("customer")>, JSONSAXValidator>,
 		InputDesc<CustomerInfo, BodyParam, QueryStringValidator>,
 		InputDesc<std::string_view, VerbParam>,
 		InputDesc<std::string_view, PathParam>,
@@ -1,12 +1,76 @@
 #ifndef BEAST_REQUEST_ADAPTER_HPP
 #define BEAST_REQUEST_ADAPTER_HPP
 
+#include <array>
 #include <boost/asio/ip/tcp.hpp>
 #include <boost/beast/http.hpp>
+#include "Compression.hpp"
+#include <cstddef>
+#include <cstdint>
+#include "ETag.hpp"
+#include "HeaderKey.hpp"
+#include <memory>
+#include "Metrics.hpp"
+#include <optional>
 #include "RequestAdapter.hpp"
 #include "SecureRequestHandler.hpp"
+#include "StreamedOutput.hpp"
+#include <string>
 #include <string_view>
 #include <type_traits>
+#include <utility>
+
+namespace detail
+{
+	// Past this capacity, the thread's serialization buffer is released rather than kept for the next response.
+	constexpr std::size_t retainedSerializationCapacity = 1024 * 1024;
+	
+	// Serializers able to append into a buffer write into a buffer reused by every response of the thread,
+	// which is then copied in the body with a single allocation. Other serializers return their own string.
+	template <typename SerializerType, typename ValueType>
+	void serializeBody(std::string& body, const ValueType& val)
+	{
+		timeSerialization([&] {
+			if constexpr (std::is_invocable_v<const SerializerType&, const ValueType&, std::string&>) {
+				thread_local std::string buffer;
+				buffer.clear();
+				SerializerType{}(val, buffer);
+				body.assign(buffer);
+				if (buffer.capacity() > retainedSerializationCapacity) {
+					std::string{}.swap(buffer);
+				}
+			} else {
+				body = SerializerType{}(val);
+			}
+		});
+	}
+	
+	// Turns a tagged response into 304 Not Modified when the request's If-None-Match matches its
+	// tag. Other methods than GET and HEAD are answered in full.
+	template <typename RequestType, typename Body>
+	bool answerNotModified(boost::beast::http::response<Body>& res, const RequestType& req)
+	{
+		using boost::beast::http::field;
+		using boost::beast::http::verb;
+		if (req.method() != verb::get && req.method() != verb::head) {
+			return false;
+		}
+		const auto ifNoneMatch = req.find(field::if_none_match);
+		const auto etag = res.find(field::etag);
+		if (ifNoneMatch == req.end() || etag == res.end()) {
+			return false;
+		}
+		const auto condition = ifNoneMatch->value();
+		const auto tag = etag->value();
+		if (!matchesIfNoneMatch(std::string_view{condition.data(), condition.size()}, std::string_view{tag.data(), tag.size()})) {
+			return false;
+		}
+		res.result(boost::beast::http::status::not_modified);
+		res.erase(field::content_length);
+		res.body() = typename Body::value_type{};
+		return true;
+	}
+}
 
 template <typename RequestType, typename SerializerType>
 struct BeastMakeResponse
@@ -24,8 +88,8 @@ struct BeastMakeResponse
 		response_type response{boost::beast::http::status::ok, req.version()};
 		static_assert(!std::is_same_v<typename SerializerType::value_type, void>, "Can't provide a body for Output<void, /* … */>");
 		if constexpr (!std::is_same_v<typename SerializerType::value_type, void>) {
-			response.body() = SerializerType{}(val);
-			response.prepare_payload();
+			detail::serializeBody<SerializerType>(response.body(), val);
+			preparePayload(response);
 		}
 		return response;
 	}
@@ -41,12 +105,163 @@ struct BeastMakeResponse
 		response_type response{status, req.version()};
 		static_assert(!std::is_same_v<typename SerializerType::value_type, void>, "Can't provide a body for Output<void, /* ... */>");
 		if constexpr (!std::is_same_v<typename SerializerType::value_type, void>) {
-			response.body() = SerializerType{}(val);
-			response.prepare_payload();
+			detail::serializeBody<SerializerType>(response.body(), val);
+			preparePayload(response);
 		}
 		return response;
 	}
 	
+	const request_type& req;
+	
+private:
+	void preparePayload(response_type& response) const
+	{
+		if constexpr (detail::isETagSerializer<SerializerType>::value) {
+			if (boost::beast::http::to_status_class(response.result()) == boost::beast::http::status_class::successful) {
+				response.set(boost::beast::http::field::etag, makeETag(response.body()));
+				if (detail::answerNotModified(response, req)) {
+					return;
+				}
+			}
+		}
+		response.prepare_payload();
+	}
+};
+
+// A body serialized once and shared by the responses copied from it, e.g. by a ResponseCache.
+struct BeastSharedBody
+{
+	using value_type = std::shared_ptr<const SharedBody>;
+	
+	static std::uint64_t size(const value_type& body)
+	{
+		return body ? body->content().size() : 0;
+	}
+	
+	class writer
+	{
+	public:
+		using const_buffers_type = boost::asio::const_buffer;
+		
+		template <bool isRequest, typename Fields>
+		writer(const boost::beast::http::header<isRequest, Fields>&, const value_type& body) : body{body}
+		{}
+		
+		void init(boost::beast::error_code& ec)
+		{
+			ec = {};
+		}
+		
+		boost::optional<std::pair<const_buffers_type, bool>> get(boost::beast::error_code& ec)
+		{
+			ec = {};
+			if (!body) {
+				return boost::none;
+			}
+			return {{const_buffers_type{body->content().data(), body->content().size()}, false}};
+		}
+		
+	private:
+		const value_type& body;
+	};
+};
+
+// The response of a cached handler, copying it only copies its header.
+class BeastSharedResponse : public boost::beast::http::response<BeastSharedBody>
+{
+public:
+	BeastSharedResponse() = default;
+	
+	// The body of a whole response is moved into the shared one, so that they can share a Router.
+	BeastSharedResponse(boost::beast::http::response<boost::beast::http::string_body>&& response)
+	: boost::beast::http::response<BeastSharedBody>{std::move(response.base()), std::make_shared<const SharedBody>(std::move(response.body()))}
+	{}
+};
+
+// A response whose body is produced in batches while the connection drains, see StreamedOutput.hpp.
+class BeastStreamedResponse
+{
+public:
+	using message_type = boost::beast::http::response<boost::beast::http::buffer_body>;
+	
+	BeastStreamedResponse(message_type&& header, StreamedBody&& body)
+	: header{std::move(header)}
+	, body{std::move(body)}
+	{}
+	
+	// Whole responses are sent as a single batch, so that they can share a Router with streamed ones.
+	BeastStreamedResponse(boost::beast::http::response<boost::beast::http::string_body>&& response)
+	: header{std::move(response.base())}
+	, body{StreamedBody::make(std::move(response.body()))}
+	{}
+	
+	BeastStreamedResponse(BeastSharedResponse&& response)
+	: header{std::move(response.base())}
+	, body{StreamedBody::make(response.body() ? response.body()->content() : std::string{})}
+	{}
+	
+	message_type& message()
+	{
+		return header;
+	}
+	
+	// Appends the next batch to out, returns false once the last batch was produced.
+	bool produce(std::string& out)
+	{
+		return body.produce(out);
+	}
+	
+	void keep_alive(bool value)
+	{
+		// Without a length nor chunks, the end of the body is the end of the connection, unless the status has no body.
+		const auto status = header.result();
+		const bool bodiless = status == boost::beast::http::status::not_modified || status == boost::beast::http::status::no_content;
+		header.keep_alive(value && (bodiless || header.chunked() || header.has_content_length()));
+	}
+	
+	bool need_eof() const
+	{
+		return header.need_eof();
+	}
+	
+private:
+	message_type header;
+	StreamedBody body;
+};
+
+template <typename RequestType, typename SerializerType>
+struct BeastMakeStreamedResponse
+{
+	using request_type = RequestType;
+	using response_type = BeastStreamedResponse;
+	using element_serializer_type = typename SerializerType::element_serializer_type;
+	
+	BeastMakeStreamedResponse(const request_type& req) : req{req}
+	{}
+	
+	// source is a range or a generator of SerializerType::value_type, it is kept until the body is sent.
+	template <typename Source>
+	response_type operator()(Source&& source)
+	{
+		return (*this)(boost::beast::http::status::ok, std::forward<Source>(source));
+	}
+	
+	response_type operator()(boost::beast::http::status status)
+	{
+		return response_type{boost::beast::http::response<boost::beast::http::string_body>{status, req.version()}};
+	}
+	
+	template <typename Source>
+	response_type operator()(boost::beast::http::status status, Source&& source)
+	{
+		typename response_type::message_type header{status, req.version()};
+		// HTTP/1.0 has no chunks, the body ends with the connection instead.
+		if (req.version() >= 11) {
+			header.chunked(true);
+		}
+		return response_type{std::move(header), StreamedBody::make<element_serializer_type>(std::forward<Source>(source))};
+	}
+	
 	const request_type& req;
 };
 
@@ -60,6 +275,8 @@ struct RequestAdapter<boost::beast::http::request<boost::beast::http::string_bod
 	using status_type = boost::beast::http::status;
 	
 	constexpr static status_type BadRequest = status_type::bad_request;
+	constexpr static status_type MethodNotAllowed = status_type::method_not_allowed;
+	constexpr static status_type NotFound = status_type::not_found;
 	constexpr static status_type Ok = status_type::ok;
 	
 	static std::string_view getHeader(const request_type& req, std::string_view name)
@@ -73,6 +290,44 @@ struct RequestAdapter<boost::beast::http::request<boost::beast::http::string_bod
 		return std::string_view{};
 	}
 	
+	// Single pass over the fields. Beast parses well-known names into a field enum, which the keys are
+	// resolved to once, so that only the other names are hashed and compared as strings.
+	template <typename ... Keys>
+	static std::array<std::string_view, sizeof...(Keys)> getHeaders(const request_type& req)
+	{
+		using boost::beast::http::field;
+		constexpr std::size_t count = sizeof...(Keys);
+		constexpr std::array<HeaderKey, count> keys{{headerKey<Keys>...}};
+		static const std::array<field, count> fields{{boost::beast::http::string_to_field(boost::string_view{headerKey<Keys>.name.data(), headerKey<Keys>.name.size()})...}};
+		std::array<std::string_view, count> values{};
+		std::array<bool, count> found{};
+		std::size_t remaining = count;
+		for (auto it = req.begin(); it != req.end() && remaining > 0; ++it) {
+			const auto name = it->name();
+			std::optional<std::uint32_t> hash;
+			for (std::size_t i = 0; i < count; ++i) {
+				if (found[i] || fields[i] != name) {
+					continue;
+				}
+				if (name == field::unknown) {
+					const auto sv = it->name_string();
+					const auto nameString = std::string_view{sv.data(), sv.size()};
+					if (!hash) {
+						hash = detail::hashHeaderName(nameString);
+					}
+					if (*hash != keys[i].hash || !detail::equalHeaderNames(nameString, keys[i].name)) {
+						continue;
+					}
+				}
+				const auto sv = it->value();
+				values[i] = std::string_view{sv.data(), sv.size()};
+				found[i] = true;
+				--remaining;
+			}
+		}
+		return values;
+	}
+	
 	static std::string_view getBody(const request_type& req)
 	{
 		static_assert(!std::is_same_v<request_body_type, std::string>, "Boost::Beast request adapter only supports boost::beast::http::string_body and boost::beast::http::empty_body");
@@ -80,27 +335,33 @@ struct RequestAdapter<boost::beast::http::request<boost::beast::http::string_bod
 		return std::string_view{sv.data(), sv.size()};
 	}
 	
+	static char* getMutableBody(request_type& req)
+	{
+		return req.body().data();
+	}
+	
 	static std::string_view getPath(const request_type& req)
 	{
-		const auto sv = req.target();
-		const auto itBegin = sv.begin();
-		const auto itEnd = sv.end();
-		auto itSeparateur = std::find(itBegin, itEnd, '?');
-		const auto distance = std::distance(itBegin, itSeparateur);
-		return std::string_view{sv.data(), static_cast<std::string_view::size_type>(distance)};
+		return splitTarget(req).first;
 	}
 	
 	static std::string_view getQueryString(const request_type& req)
+	{
+		return splitTarget(req).second;
+	}
+	
+	static std::pair<std::string_view, std::string_view> splitTarget(const request_type& req)
 	{
 		const auto sv = req.target();
 		const auto itBegin = sv.begin();
 		const auto itEnd = sv.end();
 		auto itSeparateur = std::find(itBegin, itEnd, '?');
+		const auto distance = static_cast<std::string_view::size_type>(std::distance(itBegin, itSeparateur));
+		const auto path = std::string_view{sv.data(), distance};
 		if (itSeparateur != itEnd) {
-			const auto distance = std::distance(itBegin, itSeparateur) + 1;
-			return std::string_view{sv.data() + distance, static_cast<std::string_view::size_type>(sv.size() - distance)};
+			return {path, std::string_view{sv.data() + distance + 1, sv.size() - distance - 1}};
 		} else {
-			return std::string_view{sv.data() + sv.size(), 0};
+			return {path, std::string_view{sv.data() + sv.size(), 0}};
 		}
 	}
 	
@@ -110,11 +371,70 @@ struct RequestAdapter<boost::beast::http::request<boost::beast::http::string_bod
 		return std::string_view{sv.data(), sv.size()};
 	}
 	
+	// Lists the verbs of a method_not_allowed response, see Router.hpp.
+	static void setAllowedVerbs(boost::beast::http::response_header<>& header, std::string_view verbs)
+	{
+		header.set(boost::beast::http::field::allow, boost::beast::string_view{verbs.data(), verbs.size()});
+	}
+	
+	static void setAllowedVerbs(BeastStreamedResponse& res, std::string_view verbs)
+	{
+		setAllowedVerbs(res.message(), verbs);
+	}
+	
+	// Cached responses share their body, see ResponseCache.hpp. Successful responses are cached.
+	using cached_response_type = BeastSharedResponse;
+	
+	static bool isCacheable(const cached_response_type& res)
+	{
+		return boost::beast::http::to_status_class(res.result()) == boost::beast::http::status_class::successful;
+	}
+	
+	static std::size_t responseSize(const cached_response_type& res)
+	{
+		std::size_t size = sizeof(cached_response_type) + BeastSharedBody::size(res.body());
+		for (const auto& field : res) {
+			size += field.name_string().size() + field.value().size();
+		}
+		return size;
+	}
+	
+	// Tagged responses are revalidated against the request, see ETag.hpp.
+	static void prepareCachedResponse(cached_response_type& res, const request_type& req)
+	{
+		res.version(req.version());
+		detail::answerNotModified(res, req);
+	}
+	
 	template <typename SerializerType>
-	using make_response_type = BeastMakeResponse<request_type, SerializerType>;
+	using make_response_type = std::conditional_t<
+		detail::isStreamedSerializer<SerializerType>::value,
+		BeastMakeStreamedResponse<request_type, SerializerType>,
+		BeastMakeResponse<request_type, SerializerType>
+	>;
 };
 
 template <typename OutputDesc, typename ... InputDesc>
 using BeastRequestHandler = RequestHandler<boost::beast::http::request<boost::beast::http::string_body>, OutputDesc, InputDesc...>;
 
+template <typename Observer, typename OutputDesc, typename ... InputDesc>
+using BeastObservedRequestHandler = ObservedRequestHandler<boost::beast::http::request<boost::beast::http::string_body>, Observer, OutputDesc, InputDesc...>;
+
+template <typename OutputDesc, typename ... InputDesc, typename Handler>
+auto makeBeastRequestHandler(Handler&& handler)
+{
+	return makeRequestHandler<boost::beast::http::request<boost::beast::http::string_body>, OutputDesc, InputDesc...>(std::forward<Handler>(handler));
+}
+
+template <typename OutputDesc, typename ... InputDesc, typename Handler, typename Observer>
+auto makeBeastRequestHandler(Handler&& handler, Observer&& observer)
+{
+	return makeRequestHandler<boost::beast::http::request<boost::beast::http::string_body>, OutputDesc, InputDesc...>(std::forward<Handler>(handler), std::forward<Observer>(observer));
+}
+
+inline auto makeBeastMetricsHandler(const MetricsRegistry& registry = MetricsRegistry::global())
+{
+	return makeMetricsHandler<boost::beast::http::request<boost::beast::http::string_body>>(registry);
+}
+
 #endif
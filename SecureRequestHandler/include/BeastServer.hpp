@@ -0,0 +1,820 @@
+#ifndef BEAST_SERVER_HPP
+#define BEAST_SERVER_HPP
+
+#include <algorithm>
+#include "BodyChecker.hpp"
+#include <boost/asio/dispatch.hpp>
+#include <boost/asio/executor_work_guard.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/write.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/http.hpp>
+#include <chrono>
+#include "Compression.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+/**
+ * Asynchronous HTTP server hosting any invocable with signature
+ * `response operator()(const boost::beast::http::request<string_body>&)`,
+ * such as a BeastRequestHandler. The response is either a beast message or
+ * a streamed response, whose body is produced in batches as it is written.
+ *
+ * Connections are spread in round-robin over a pool of io_contexts, each of
+ * which is run by a single thread. A session never leaves the io_context it
+ * was assigned to, so no strand or lock is needed to serialize its handlers.
+ *
+ * Requests pipelined by the client, which are already complete in the read buffer when a
+ * response is ready, are handled right away and their responses are sent along with it in
+ * a single gathered write, rather than with a write each.
+ *
+ * Once setCompression is called, responses are compressed with the coding the client
+ * accepts, see Compression.hpp. Compression is applied to the handler's response, so that
+ * cached responses and entity tags don't depend on the coding.
+ *
+ *   BeastServer server{reqHandler};
+ *   server.listen({boost::asio::ip::make_address("0.0.0.0"), 8080});
+ *   server.run();
+ */
+
+namespace detail
+{
+	// Clients closing their connection, idle connections timing out and the server stopping are routine.
+	inline void reportFailure(boost::beast::error_code ec, const char* what)
+	{
+		if (ec == boost::beast::http::error::end_of_stream || ec == boost::asio::error::operation_aborted || ec == boost::beast::error::timeout) {
+			return;
+		}
+		std::cerr << what << ": " << ec.message() << '\n';
+	}
+
+	inline std::size_t defaultThreadCount()
+	{
+		return std::max(1u, std::thread::hardware_concurrency());
+	}
+
+	// Handlers may provide a checker fed with the body while it is received, see BodyChecker.hpp.
+	template <typename Handler, typename Request, typename = void>
+	struct sessionBodyChecker
+	{
+		using type = NoBodyChecker;
+
+		static type make(const Handler&, const Request&)
+		{
+			return type{};
+		}
+	};
+	template <typename Handler, typename Request>
+	struct sessionBodyChecker<Handler, Request, std::void_t<decltype(std::declval<const Handler&>().bodyChecker(std::declval<const Request&>()))>>
+	{
+		using type = decltype(std::declval<const Handler&>().bodyChecker(std::declval<const Request&>()));
+
+		static type make(const Handler& handler, const Request& req)
+		{
+			return handler.bodyChecker(req);
+		}
+	};
+
+	// Handlers may validate the inputs read from the header before the body is received, keeping
+	// what they validated in a pending request they are invoked with once the body is received.
+	template <typename Handler, typename Request, typename = void>
+	struct sessionHeaderValidation
+	{
+		using pending_type = std::monostate;
+
+		static std::optional<boost::beast::http::status> validate(const Handler&, Request&, std::optional<pending_type>&)
+		{
+			return std::nullopt;
+		}
+
+		static auto respond(const Handler& handler, Request& req, std::optional<pending_type>&)
+		{
+			return handler(req);
+		}
+
+		static void rejectBody(const Handler&, const Request&, std::optional<pending_type>&) {}
+	};
+	template <typename Handler, typename Request>
+	struct sessionHeaderValidation<Handler, Request, std::void_t<typename Handler::pending_request_type>>
+	{
+		using pending_type = typename Handler::pending_request_type;
+
+		static std::optional<boost::beast::http::status> validate(const Handler& handler, Request& req, std::optional<pending_type>& pending)
+		{
+			return handler.validateHeaders(req, pending);
+		}
+
+		// Requests which skipped the early checks, e.g. pipelined ones, are validated entirely by the handler.
+		static auto respond(const Handler& handler, Request& req, std::optional<pending_type>& pending) -> decltype(handler(req))
+		{
+			if (pending) {
+				return handler(req, *pending);
+			}
+			return handler(req);
+		}
+
+		static void rejectBody(const Handler& handler, const Request& req, std::optional<pending_type>& pending)
+		{
+			if (pending) {
+				handler.rejectBody(req, *pending);
+			}
+		}
+	};
+
+	// Routers list the verbs allowed on the path of a request answered with method_not_allowed.
+	template <typename Handler, typename Request, typename = void>
+	struct sessionAllowedVerbs
+	{
+		static std::string_view get(const Handler&, const Request&)
+		{
+			return {};
+		}
+	};
+	template <typename Handler, typename Request>
+	struct sessionAllowedVerbs<Handler, Request, std::void_t<decltype(std::declval<const Handler&>().allowedVerbs(std::declval<const Request&>()))>>
+	{
+		static std::string_view get(const Handler& handler, const Request& req)
+		{
+			return handler.allowedVerbs(req);
+		}
+	};
+
+	// The body of a request rejected from its header is still read past this size, so that the connection can be reused.
+	constexpr std::uint64_t drainedBodyLimit = 64 * 1024;
+
+	// Responses written together at most, when the client pipelines its requests.
+	constexpr std::size_t pipelineDepth = 16;
+	// Smaller pieces of the gathered responses are copied rather than written in place.
+	constexpr std::size_t copiedPieceSize = 1024;
+
+	// Streamed responses (e.g. BeastStreamedResponse) produce their body in batches as it is written.
+	template <typename Response, typename = void>
+	struct isStreamedResponse : std::false_type {};
+	template <typename Response>
+	struct isStreamedResponse<Response, std::void_t<decltype(std::declval<Response&>().produce(std::declval<std::string&>()))>> : std::true_type {};
+
+	// The message of a response, streamed responses hold it apart from their body.
+	template <typename Response, bool = isStreamedResponse<Response>::value>
+	struct responseMessage
+	{
+		using type = Response;
+	};
+	template <typename Response>
+	struct responseMessage<Response, true>
+	{
+		using type = std::decay_t<decltype(std::declval<Response&>().message())>;
+	};
+
+	// Whether a response of this status has a body at all.
+	inline bool hasCompressibleStatus(boost::beast::http::status status)
+	{
+		return boost::beast::http::to_status_class(status) != boost::beast::http::status_class::informational
+			&& status != boost::beast::http::status::no_content
+			&& status != boost::beast::http::status::not_modified;
+	}
+
+	// Tells caches that the body of the response depends on Accept-Encoding, compressed or not.
+	inline void varyOnAcceptEncoding(boost::beast::http::response_header<>& header)
+	{
+		const auto vary = header[boost::beast::http::field::vary];
+		if (vary.empty()) {
+			header.set(boost::beast::http::field::vary, "Accept-Encoding");
+		} else if (vary.find("Accept-Encoding") == boost::beast::string_view::npos) {
+			header.set(boost::beast::http::field::vary, std::string{vary.data(), vary.size()} + ", Accept-Encoding");
+		}
+	}
+
+	inline bool compressWholeBody(std::string& body, ContentCoding coding, int level)
+	{
+		return compressBody(body, coding, level);
+	}
+
+	// A shared body (e.g. a cached one) is left as is for its other responses, this one gets the
+	// compressed variant, which is only made by the first response needing it.
+	inline bool compressWholeBody(std::shared_ptr<const SharedBody>& body, ContentCoding coding, int level)
+	{
+		if (!body) {
+			return false;
+		}
+		auto compressed = body->compressed(coding, level);
+		if (!compressed) {
+			return false;
+		}
+		body = std::move(compressed);
+		return true;
+	}
+
+	// A compressed body is only equivalent to the uncompressed one, so a strong entity tag becomes weak.
+	inline void markEncoded(boost::beast::http::response_header<>& header, ContentCoding coding)
+	{
+		const auto name = contentCodingName(coding);
+		header.set(boost::beast::http::field::content_encoding, boost::beast::string_view{name.data(), name.size()});
+		const auto etag = header[boost::beast::http::field::etag];
+		if (!etag.empty() && etag[0] == '"') {
+			header.set(boost::beast::http::field::etag, "W/" + std::string{etag.data(), etag.size()});
+		}
+	}
+}
+
+template <typename Handler>
+class BeastSession : public std::enable_shared_from_this<BeastSession<Handler>>
+{
+public:
+	using request_type = boost::beast::http::request<boost::beast::http::string_body>;
+	using response_type = std::decay_t<std::invoke_result_t<const Handler&, const request_type&>>;
+	using body_checker_type = detail::sessionBodyChecker<Handler, request_type>;
+	using header_validation_type = detail::sessionHeaderValidation<Handler, request_type>;
+
+	BeastSession(boost::asio::ip::tcp::socket&& socket, const Handler& handler, std::chrono::steady_clock::duration timeout, std::optional<CompressionOptions> compression)
+	: stream{std::move(socket)}
+	, handler{handler}
+	, timeout{timeout}
+	, compression{compression}
+	{}
+
+	void run()
+	{
+		// The socket belongs to another io_context than the acceptor's, hop
+		// onto it before starting any operation.
+		boost::asio::dispatch(
+			stream.get_executor(),
+			boost::beast::bind_front_handler(&BeastSession::doRead, this->shared_from_this())
+		);
+	}
+
+private:
+	void doRead()
+	{
+		pending.reset();
+		parser = std::make_unique<boost::beast::http::request_parser<boost::beast::http::string_body>>();
+		checkedBodySize = 0;
+		rejection.reset();
+		stream.expires_after(timeout);
+		boost::beast::http::async_read_header(
+			stream,
+			buffer,
+			*parser,
+			boost::beast::bind_front_handler(&BeastSession::onReadHeader, this->shared_from_this())
+		);
+	}
+
+	void onReadHeader(boost::beast::error_code ec, std::size_t)
+	{
+		if (ec == boost::beast::http::error::end_of_stream) {
+			return doClose();
+		}
+		// A Content-Length above the parser's limit is known from the header.
+		if (ec == boost::beast::http::error::body_limit) {
+			return reject(boost::beast::http::status::payload_too_large);
+		}
+		if (ec) {
+			return detail::reportFailure(ec, "read");
+		}
+		rejection = header_validation_type::validate(handler, parser->get(), pending);
+		if (rejection) {
+			// Small bodies are skipped rather than left unread, which would force the connection to close.
+			const auto length = parser->content_length();
+			if (!parser->is_done() && !(length && *length <= detail::drainedBodyLimit)) {
+				return reject(*rejection);
+			}
+			bodyChecker.reset();
+		} else {
+			bodyChecker.emplace(body_checker_type::make(handler, parser->get()));
+		}
+		doReadBody();
+	}
+
+	// The body is read as it arrives so that the handler's checker can reject it before it is complete.
+	void doReadBody()
+	{
+		if (parser->is_done()) {
+			if (rejection) {
+				return reject(*rejection, true);
+			}
+			return onRead();
+		}
+		// Each part of the body restarts the timeout, so that a long upload is only cut off once it stalls.
+		stream.expires_after(timeout);
+		boost::beast::http::async_read_some(
+			stream,
+			buffer,
+			*parser,
+			boost::beast::bind_front_handler(&BeastSession::onReadBody, this->shared_from_this())
+		);
+	}
+
+	void onReadBody(boost::beast::error_code ec, std::size_t)
+	{
+		if (ec == boost::beast::http::error::body_limit) {
+			return reject(boost::beast::http::status::payload_too_large);
+		}
+		if (ec) {
+			return detail::reportFailure(ec, "read");
+		}
+		const std::string_view body = parser->get().body();
+		// The body of a rejected request is only drained.
+		const bool valid = !bodyChecker || (bodyChecker->feed(body.substr(checkedBodySize)) && (!parser->is_done() || bodyChecker->finish()));
+		checkedBodySize = body.size();
+		if (!valid) {
+			header_validation_type::rejectBody(handler, parser->get(), pending);
+			return reject(boost::beast::http::status::bad_request);
+		}
+		doReadBody();
+	}
+
+	// Answers without invoking the handler. Unless the request was read entirely, the connection can't be reused.
+	void reject(boost::beast::http::status status, bool requestRead = false)
+	{
+		pending.reset();
+		boost::beast::http::response<boost::beast::http::string_body> res{status, parser->get().version()};
+		if (status == boost::beast::http::status::method_not_allowed) {
+			const auto verbs = detail::sessionAllowedVerbs<Handler, request_type>::get(handler, parser->get());
+			res.set(boost::beast::http::field::allow, boost::beast::string_view{verbs.data(), verbs.size()});
+		}
+		res.keep_alive(requestRead && parser->get().keep_alive());
+		res.prepare_payload();
+		response.emplace(std::move(res));
+		doWrite();
+	}
+
+	// The request stays in the parser, where the context of its pending validation refers to it.
+	void onRead()
+	{
+		respond();
+		// Requests the client pipelined behind this one are answered in the same write, as long as
+		// they are already complete in the buffer and the connection remains open after each response.
+		while (pipelined.size() + 1 < detail::pipelineDepth && isPipelinable(*response) && readBufferedRequest()) {
+			if (!park()) {
+				return doClose();
+			}
+			// The pending validation refers to the request being replaced.
+			pending.reset();
+			parser = std::move(nextParser);
+			respond();
+		}
+		if (pipelined.empty()) {
+			return doWrite();
+		}
+		// Otherwise the last response is written on its own once the others are sent.
+		if (isPipelinable(*response) && !park()) {
+			return doClose();
+		}
+		doWritePipelined();
+	}
+
+	// Moves the response to the gathered write. A streamed body is produced right away, while
+	// the request and the pending validation it may refer to are still alive.
+	bool park()
+	{
+		auto& entry = *pipelined.emplace_back(std::make_unique<PipelinedResponse>(std::move(*response)));
+		response.reset();
+		if constexpr (detail::isStreamedResponse<response_type>::value) {
+			try {
+				while (entry.response.produce(entry.body)) {
+				}
+			} catch (const std::exception& e) {
+				std::cerr << "stream: " << e.what() << '\n';
+				return false;
+			}
+		}
+		return true;
+	}
+
+	void respond()
+	{
+		auto& request = parser->get();
+		try {
+			response.emplace(header_validation_type::respond(handler, request, pending));
+			compress();
+			response->keep_alive(request.keep_alive());
+		} catch (const std::exception& e) {
+			std::cerr << "handler: " << e.what() << '\n';
+			response.emplace(boost::beast::http::response<boost::beast::http::string_body>{boost::beast::http::status::internal_server_error, request.version()});
+			response->keep_alive(false);
+		}
+	}
+
+	// Parses the next request into nextParser if it is complete in the buffer. Otherwise, it is left to doRead, which also reports malformed requests.
+	bool readBufferedRequest()
+	{
+		if (buffer.size() == 0) {
+			return false;
+		}
+		nextParser = std::make_unique<boost::beast::http::request_parser<boost::beast::http::string_body>>();
+		nextParser->eager(true);
+		const auto data = buffer.data();
+		std::size_t used = 0;
+		while (!nextParser->is_done()) {
+			boost::beast::error_code ec;
+			const auto size = nextParser->put(boost::asio::const_buffer{static_cast<const char*>(data.data()) + used, data.size() - used}, ec);
+			used += size;
+			if (ec || size == 0) {
+				return false;
+			}
+		}
+		buffer.consume(used);
+		return true;
+	}
+
+	// Only whole responses are gathered, a streamed body is produced while the connection drains.
+	static bool isPipelinable(response_type& res)
+	{
+		if constexpr (detail::isStreamedResponse<response_type>::value) {
+			return !res.need_eof() && !res.message().chunked();
+		} else {
+			return !res.need_eof();
+		}
+	}
+
+	// Whole bodies are compressed at once, streamed ones batch by batch as they are produced.
+	void compress()
+	{
+		using boost::beast::http::field;
+		if (!compression || parser->get().method() == boost::beast::http::verb::head) {
+			return;
+		}
+		auto& header = messageOf(*response);
+		if (!detail::hasCompressibleStatus(header.result()) || header.find(field::content_encoding) != header.end()) {
+			return;
+		}
+		if constexpr (detail::isStreamedResponse<response_type>::value) {
+			// Whole responses sent through a streamed response have a length, the compressed one isn't known.
+			if (header.has_content_length()) {
+				const auto length = header[field::content_length];
+				if (header.version() < 11 || std::strtoull(std::string{length.data(), length.size()}.c_str(), nullptr, 10) < compression->threshold) {
+					return;
+				}
+			}
+			detail::varyOnAcceptEncoding(header);
+			const auto coding = negotiateContentCoding(acceptEncoding());
+			if (coding == ContentCoding::identity) {
+				return;
+			}
+			if (header.has_content_length()) {
+				header.erase(field::content_length);
+				header.chunked(true);
+			}
+			detail::markEncoded(header, coding);
+			streamCompressor.emplace(coding, compression->level);
+		} else {
+			using body_type = typename response_type::body_type;
+			if (body_type::size(response->body()) < compression->threshold) {
+				return;
+			}
+			detail::varyOnAcceptEncoding(header);
+			const auto coding = negotiateContentCoding(acceptEncoding());
+			if (coding == ContentCoding::identity || !detail::compressWholeBody(response->body(), coding, compression->level)) {
+				return;
+			}
+			detail::markEncoded(header, coding);
+			response->prepare_payload();
+		}
+	}
+
+	std::string_view acceptEncoding() const
+	{
+		const auto value = parser->get()[boost::beast::http::field::accept_encoding];
+		return std::string_view{value.data(), value.size()};
+	}
+
+	template <typename Response>
+	static auto& messageOf(Response& res)
+	{
+		if constexpr (detail::isStreamedResponse<Response>::value) {
+			return res.message();
+		} else {
+			return res;
+		}
+	}
+
+	void doWrite()
+	{
+		if constexpr (detail::isStreamedResponse<response_type>::value) {
+			streamSerializer.emplace(response->message());
+			doWriteBatch();
+		} else {
+			stream.expires_after(timeout);
+			boost::beast::http::async_write(
+				stream,
+				*response,
+				boost::beast::bind_front_handler(&BeastSession::onWrite, this->shared_from_this(), response->need_eof())
+			);
+		}
+	}
+
+	// The next batch is only produced once the previous one was written, so a
+	// response never holds more than one batch whatever the size of its body.
+	void doWriteBatch()
+	{
+		batch.clear();
+		bool more = false;
+		try {
+			if (streamCompressor) {
+				plainBatch.clear();
+				more = response->produce(plainBatch);
+				streamCompressor->compress(plainBatch, batch, !more);
+			} else {
+				more = response->produce(batch);
+			}
+		} catch (const std::exception& e) {
+			// The header is already gone, closing is the only way to tell the body is incomplete.
+			std::cerr << "stream: " << e.what() << '\n';
+			return doClose();
+		}
+		auto& body = response->message().body();
+		body.data = batch.empty() ? nullptr : batch.data();
+		body.size = batch.size();
+		body.more = more;
+		stream.expires_after(timeout);
+		boost::beast::http::async_write(
+			stream,
+			*streamSerializer,
+			boost::beast::bind_front_handler(&BeastSession::onWriteBatch, this->shared_from_this())
+		);
+	}
+
+	void doWritePipelined()
+	{
+		pieces.clear();
+		copied.clear();
+		std::size_t run = 0;
+		try {
+			for (auto& entry : pipelined) {
+				gather(*entry, run);
+			}
+		} catch (const std::exception& e) {
+			std::cerr << "stream: " << e.what() << '\n';
+			return doClose();
+		}
+		if (run > 0) {
+			pieces.emplace_back(nullptr, run);
+		}
+		// Copied runs only get their address now that copied no longer grows.
+		gathered.clear();
+		std::size_t offset = 0;
+		for (const auto& piece : pieces) {
+			if (piece.data() == nullptr) {
+				gathered.emplace_back(copied.data() + offset, piece.size());
+				offset += piece.size();
+			} else {
+				gathered.push_back(piece);
+			}
+		}
+		stream.expires_after(timeout);
+		boost::asio::async_write(
+			stream,
+			gathered,
+			boost::beast::bind_front_handler(&BeastSession::onWritePipelined, this->shared_from_this())
+		);
+	}
+
+	// Appends the buffers of a response to the pieces of the gathered write. Headers are made of
+	// many small buffers, some of them in the serializer which reuses them once consumed: they are
+	// copied together, run is the size of the last run of copied bytes. Large bodies are written
+	// from where they are, in the message which outlives the write.
+	template <typename Entry>
+	void gather(Entry& entry, std::size_t& run)
+	{
+		auto& message = messageOf(entry.response);
+		if constexpr (detail::isStreamedResponse<response_type>::value) {
+			// Never null, so that the body is serialized along with the header.
+			message.body().data = entry.body.data();
+			message.body().size = entry.body.size();
+			message.body().more = false;
+		}
+		boost::beast::http::response_serializer<typename detail::responseMessage<response_type>::type::body_type> serializer{message};
+		boost::beast::error_code ec;
+		while (!ec && !serializer.is_done()) {
+			std::size_t size = 0;
+			serializer.next(ec, [&](boost::beast::error_code&, const auto& buffers) {
+				for (const auto piece : boost::beast::buffers_range_ref(buffers)) {
+					if (piece.size() < detail::copiedPieceSize) {
+						copied.append(static_cast<const char*>(piece.data()), piece.size());
+						run += piece.size();
+						continue;
+					}
+					// A run of copied bytes is marked with a null address.
+					if (run > 0) {
+						pieces.emplace_back(nullptr, run);
+						run = 0;
+					}
+					pieces.push_back(piece);
+				}
+				size = boost::beast::buffer_bytes(buffers);
+			});
+			serializer.consume(size);
+		}
+		if (ec) {
+			throw boost::system::system_error{ec};
+		}
+	}
+
+	void onWritePipelined(boost::beast::error_code ec, std::size_t)
+	{
+		pipelined.clear();
+		if (ec) {
+			return detail::reportFailure(ec, "write");
+		}
+		if (response) {
+			return doWrite();
+		}
+		doRead();
+	}
+
+	void onWriteBatch(boost::beast::error_code ec, std::size_t bytes)
+	{
+		if (ec == boost::beast::http::error::need_buffer) {
+			ec = {};
+		}
+		if (ec) {
+			return detail::reportFailure(ec, "write");
+		}
+		if (!streamSerializer->is_done()) {
+			return doWriteBatch();
+		}
+		const bool close = response->need_eof();
+		streamSerializer.reset();
+		streamCompressor.reset();
+		onWrite(close, ec, bytes);
+	}
+
+	void onWrite(bool close, boost::beast::error_code ec, std::size_t)
+	{
+		if (ec) {
+			return detail::reportFailure(ec, "write");
+		}
+		if (close) {
+			// This means we should close the connection, usually because
+			// the response indicated the "Connection: close" semantic.
+			return doClose();
+		}
+		response.reset();
+		doRead();
+	}
+
+	void doClose()
+	{
+		boost::beast::error_code ec;
+		stream.socket().shutdown(boost::asio::ip::tcp::socket::shutdown_send, ec);
+	}
+
+	boost::beast::tcp_stream stream;
+	boost::beast::flat_buffer buffer;
+	// Parsers can't be moved, they are held by pointer so that a pipelined one can take over.
+	std::unique_ptr<boost::beast::http::request_parser<boost::beast::http::string_body>> parser;
+	// A pipelined request, parsed while the response to the current one may still need it.
+	std::unique_ptr<boost::beast::http::request_parser<boost::beast::http::string_body>> nextParser;
+	std::optional<typename body_checker_type::type> bodyChecker;
+	std::size_t checkedBodySize = 0;
+	std::optional<boost::beast::http::status> rejection;
+	// Declared after the parser, whose request it refers to. Kept until the response is
+	// produced, since a streamed body may refer to what was validated.
+	std::optional<typename header_validation_type::pending_type> pending;
+	std::optional<response_type> response;
+	std::optional<boost::beast::http::response_serializer<boost::beast::http::buffer_body>> streamSerializer;
+	std::string batch;
+	// Streamed bodies are produced here, then compressed into batch.
+	std::string plainBatch;
+	std::optional<Compressor> streamCompressor;
+	// A response waiting for the gathered write, which may refer to its body.
+	struct PipelinedResponse
+	{
+		explicit PipelinedResponse(response_type&& response) : response{std::move(response)}
+		{}
+
+		response_type response;
+		// The produced body of a streamed response.
+		std::string body;
+	};
+	std::vector<std::unique_ptr<PipelinedResponse>> pipelined;
+	std::vector<boost::asio::const_buffer> pieces;
+	std::string copied;
+	std::vector<boost::asio::const_buffer> gathered;
+	const Handler& handler;
+	std::chrono::steady_clock::duration timeout;
+	std::optional<CompressionOptions> compression;
+};
+
+template <typename Handler>
+class BeastServer
+{
+public:
+	using executor_type = boost::asio::io_context::executor_type;
+
+	BeastServer(Handler handler, std::size_t threadCount = detail::defaultThreadCount())
+	: handler{std::move(handler)}
+	{
+		threadCount = std::max<std::size_t>(threadCount, 1);
+		contexts.reserve(threadCount);
+		guards.reserve(threadCount);
+		for (std::size_t i = 0; i < threadCount; ++i) {
+			contexts.push_back(std::make_unique<boost::asio::io_context>(1));
+			guards.push_back(boost::asio::make_work_guard(*contexts.back()));
+		}
+		acceptor.emplace(*contexts.front());
+	}
+
+	BeastServer(const BeastServer&) = delete;
+	BeastServer& operator=(const BeastServer&) = delete;
+
+	// Idle keep-alive connections and stalled transfers are closed after this delay.
+	void setTimeout(std::chrono::steady_clock::duration delay)
+	{
+		timeout = delay;
+	}
+
+	// Compresses the responses of clients accepting gzip or deflate, see Compression.hpp.
+	void setCompression(CompressionOptions options = {})
+	{
+		compression = options;
+	}
+
+	void listen(const boost::asio::ip::tcp::endpoint& endpoint)
+	{
+		acceptor->open(endpoint.protocol());
+		acceptor->set_option(boost::asio::socket_base::reuse_address(true));
+		acceptor->bind(endpoint);
+		acceptor->listen(boost::asio::socket_base::max_listen_connections);
+		doAccept();
+	}
+
+	boost::asio::ip::tcp::endpoint localEndpoint() const
+	{
+		return acceptor->local_endpoint();
+	}
+
+	// Blocks until stop() is called, the calling thread runs the first io_context.
+	void run()
+	{
+		std::vector<std::thread> threads;
+		threads.reserve(contexts.size() - 1);
+		for (std::size_t i = 1; i < contexts.size(); ++i) {
+			threads.emplace_back([&ioc = *contexts[i]] {
+				ioc.run();
+			});
+		}
+		contexts.front()->run();
+		for (auto& thread : threads) {
+			thread.join();
+		}
+	}
+
+	void stop()
+	{
+		boost::asio::dispatch(acceptor->get_executor(), [this] {
+			boost::beast::error_code ec;
+			acceptor->close(ec);
+		});
+		for (auto& guard : guards) {
+			guard.reset();
+		}
+		for (auto& ioc : contexts) {
+			ioc->stop();
+		}
+	}
+
+private:
+	void doAccept()
+	{
+		auto& ioc = *contexts[nextContext];
+		nextContext = (nextContext + 1) % contexts.size();
+		acceptor->async_accept(ioc, [this](boost::beast::error_code ec, boost::asio::ip::tcp::socket socket) {
+			if (ec == boost::asio::error::operation_aborted) {
+				return;
+			}
+			if (ec) {
+				detail::reportFailure(ec, "accept");
+			} else {
+				// Responses are coalesced by the session, Nagle's algorithm would only hold back the last
+				// segment of a write until the previous one is acknowledged.
+				boost::beast::error_code noDelayError;
+				socket.set_option(boost::asio::ip::tcp::no_delay{true}, noDelayError);
+				std::make_shared<BeastSession<Handler>>(std::move(socket), handler, timeout, compression)->run();
+			}
+			doAccept();
+		});
+	}
+
+	Handler handler;
+	std::vector<std::unique_ptr<boost::asio::io_context>> contexts;
+	std::vector<boost::asio::executor_work_guard<executor_type>> guards;
+	std::optional<boost::asio::ip::tcp::acceptor> acceptor;
+	std::size_t nextContext = 0;
+	std::chrono::steady_clock::duration timeout = std::chrono::seconds{30};
+	std::optional<CompressionOptions> compression;
+};
+
+#endif
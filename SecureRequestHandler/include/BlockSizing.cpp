@@ -0,0 +1,37 @@
+#include "BlockSizing.hpp"
+
+namespace
+{
+	std::size_t nextPowerOfTwo(std::size_t n)
+	{
+		std::size_t result = detail::BlockSizing::initialBlockSize;
+		while (result < n) {
+			result *= 2;
+		}
+		return result;
+	}
+}
+
+namespace detail
+{
+	void BlockSizing::setHighWaterMark(std::size_t bytes)
+	{
+		highWaterMark.store(bytes, std::memory_order_relaxed);
+	}
+	
+	std::size_t BlockSizing::getHighWaterMark() const
+	{
+		return highWaterMark.load(std::memory_order_relaxed);
+	}
+	
+	std::size_t BlockSizing::nextSize(std::size_t blockSize, std::size_t needed) const
+	{
+		const std::size_t limit = getHighWaterMark();
+		if (blockSize > limit && initialBlockSize < blockSize) {
+			return initialBlockSize;
+		} else if (needed > blockSize && needed <= limit) {
+			return nextPowerOfTwo(needed);
+		}
+		return blockSize;
+	}
+}
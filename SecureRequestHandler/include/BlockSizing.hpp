@@ -0,0 +1,36 @@
+#ifndef BLOCK_SIZING_HPP
+#define BLOCK_SIZING_HPP
+
+#include <atomic>
+#include <cstddef>
+
+/**
+ * Sizing of the blocks which thread-local pools (RequestArena, JSONPool) keep across requests.
+ *
+ * A block starts at 4 KiB and grows to the power of two fitting what a request needed, as
+ * long as that stays under the pool's high-water mark. What a request needs past the mark is
+ * freed instead of retained, and a block left above a lowered mark shrinks back to 4 KiB.
+ */
+
+namespace detail
+{
+	class BlockSizing
+	{
+	public:
+		constexpr static std::size_t initialBlockSize = 4 * 1024;
+		
+		constexpr explicit BlockSizing(std::size_t highWaterMark) : highWaterMark{highWaterMark}
+		{}
+		
+		void setHighWaterMark(std::size_t bytes);
+		std::size_t getHighWaterMark() const;
+		
+		// The size of the block for the next request, given that the last one needed needed bytes.
+		std::size_t nextSize(std::size_t blockSize, std::size_t needed) const;
+		
+	private:
+		std::atomic<std::size_t> highWaterMark;
+	};
+}
+
+#endif
@@ -0,0 +1,274 @@
+#include "BodyChecker.hpp"
+
+namespace
+{
+	bool isWhitespace(char c)
+	{
+		return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+	}
+
+	bool isDigit(char c)
+	{
+		return c >= '0' && c <= '9';
+	}
+
+	bool isHexDigit(char c)
+	{
+		return isDigit(c) || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+	}
+}
+
+bool JSONSyntaxChecker::feed(std::string_view chunk)
+{
+	for (char c : chunk) {
+		if (!step(c)) {
+			state = State::Invalid;
+			return false;
+		}
+	}
+	return true;
+}
+
+bool JSONSyntaxChecker::finish()
+{
+	if (depth != 0) {
+		return false;
+	}
+	switch (state) {
+		case State::AfterValue:
+		case State::Zero:
+		case State::Integer:
+		case State::Fraction:
+		case State::ExponentDigits:
+		case State::Done:
+			return true;
+		default:
+			return false;
+	}
+}
+
+bool JSONSyntaxChecker::step(char c)
+{
+	// Numbers only end on the character following them, which is then handled as if it followed any value.
+	for (;;) {
+		switch (state) {
+			case State::Value:
+				if (isWhitespace(c)) {
+					return true;
+				} else if (c == '{') {
+					state = State::FirstKeyOrEnd;
+					push(true);
+					return true;
+				} else if (c == '[') {
+					state = State::FirstValueOrEnd;
+					push(false);
+					return true;
+				} else if (c == '"') {
+					state = State::String;
+					inKey = false;
+				} else if (c == 't') {
+					literal = "true";
+				} else if (c == 'f') {
+					literal = "false";
+				} else if (c == 'n') {
+					literal = "null";
+				} else if (c == '-') {
+					state = State::Minus;
+				} else if (c == '0') {
+					state = State::Zero;
+				} else if (isDigit(c)) {
+					state = State::Integer;
+				} else {
+					return false;
+				}
+				if (literal) {
+					state = State::Literal;
+					progress = 1;
+				}
+				return true;
+			case State::FirstValueOrEnd:
+				if (isWhitespace(c)) {
+					return true;
+				} else if (c == ']') {
+					pop();
+					return true;
+				}
+				state = State::Value;
+				continue;
+			case State::FirstKeyOrEnd:
+				if (isWhitespace(c)) {
+					return true;
+				} else if (c == '}') {
+					pop();
+					return true;
+				}
+				state = State::Key;
+				continue;
+			case State::Key:
+				if (isWhitespace(c)) {
+					return true;
+				} else if (c == '"') {
+					state = State::String;
+					inKey = true;
+					return true;
+				}
+				return false;
+			case State::Colon:
+				if (isWhitespace(c)) {
+					return true;
+				} else if (c == ':') {
+					state = State::Value;
+					return true;
+				}
+				return false;
+			case State::AfterValue:
+				if (isWhitespace(c)) {
+					return true;
+				} else if (depth == 0) {
+					if (c == '\0') {
+						state = State::Done;
+						return true;
+					}
+					return false;
+				} else if (c == ',') {
+					state = inObject() ? State::Key : State::Value;
+					return true;
+				} else if (c == (inObject() ? '}' : ']')) {
+					pop();
+					return true;
+				}
+				return false;
+			case State::String:
+				if (c == '"') {
+					state = inKey ? State::Colon : State::AfterValue;
+				} else if (c == '\\') {
+					state = State::Escape;
+				} else if (static_cast<unsigned char>(c) < 0x20) {
+					return false;
+				}
+				return true;
+			case State::Escape:
+				if (c == 'u') {
+					state = State::Unicode;
+					progress = 0;
+					return true;
+				}
+				switch (c) {
+					case '"': case '\\': case '/': case 'b': case 'f': case 'n': case 'r': case 't':
+						state = State::String;
+						return true;
+					default:
+						return false;
+				}
+			case State::Unicode:
+				if (!isHexDigit(c)) {
+					return false;
+				}
+				if (++progress == 4) {
+					state = State::String;
+				}
+				return true;
+			case State::Literal:
+				if (c != literal[progress]) {
+					return false;
+				}
+				if (literal[++progress] == '\0') {
+					literal = nullptr;
+					state = State::AfterValue;
+				}
+				return true;
+			case State::Minus:
+				if (c == '0') {
+					state = State::Zero;
+					return true;
+				} else if (isDigit(c)) {
+					state = State::Integer;
+					return true;
+				}
+				return false;
+			case State::Zero:
+			case State::Integer:
+				if (isDigit(c) && state == State::Integer) {
+					return true;
+				} else if (c == '.') {
+					state = State::Dot;
+					return true;
+				} else if (c == 'e' || c == 'E') {
+					state = State::Exponent;
+					return true;
+				}
+				state = State::AfterValue;
+				continue;
+			case State::Dot:
+				if (isDigit(c)) {
+					state = State::Fraction;
+					return true;
+				}
+				return false;
+			case State::Fraction:
+				if (isDigit(c)) {
+					return true;
+				} else if (c == 'e' || c == 'E') {
+					state = State::Exponent;
+					return true;
+				}
+				state = State::AfterValue;
+				continue;
+			case State::Exponent:
+				if (c == '+' || c == '-') {
+					state = State::ExponentSign;
+					return true;
+				}
+				[[fallthrough]];
+			case State::ExponentSign:
+				if (isDigit(c)) {
+					state = State::ExponentDigits;
+					return true;
+				}
+				return false;
+			case State::ExponentDigits:
+				if (isDigit(c)) {
+					return true;
+				}
+				state = State::AfterValue;
+				continue;
+			case State::Done:
+				return true;
+			case State::Invalid:
+				return false;
+		}
+		return false;
+	}
+}
+
+void JSONSyntaxChecker::push(bool object)
+{
+	if (depth >= inlineDepth && (depth - inlineDepth) / 64 == deeperObjects.size()) {
+		deeperObjects.push_back(0);
+	}
+	const auto bit = std::uint64_t{1} << (depth % 64);
+	if (object) {
+		objectBits(depth) |= bit;
+	} else {
+		objectBits(depth) &= ~bit;
+	}
+	++depth;
+}
+
+void JSONSyntaxChecker::pop()
+{
+	--depth;
+	state = State::AfterValue;
+}
+
+bool JSONSyntaxChecker::inObject() const
+{
+	const auto top = depth - 1;
+	const auto bits = top < inlineDepth ? objects[top / 64] : deeperObjects[(top - inlineDepth) / 64];
+	return (bits >> (top % 64)) & 1;
+}
+
+std::uint64_t& JSONSyntaxChecker::objectBits(std::size_t level)
+{
+	return level < inlineDepth ? objects[level / 64] : deeperObjects[(level - inlineDepth) / 64];
+}
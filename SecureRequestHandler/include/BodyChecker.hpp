@@ -0,0 +1,143 @@
+#ifndef BODY_CHECKER_HPP
+#define BODY_CHECKER_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <utility>
+#include <variant>
+#include <vector>
+
+/**
+ * Body checkers look at a request body chunk by chunk while it is still being received,
+ * so that a body which can't be valid is rejected before the rest of it is read.
+ *
+ *   bool feed(std::string_view chunk) returns false as soon as the body can't be valid
+ *   bool finish() returns false unless the whole body fed so far is valid
+ *
+ * Validators name the checker matching their syntax with a body_checker_type alias. A
+ * checker is never stricter than its validator : it only rejects bodies which the validator
+ * would reject whatever it looks up in them.
+ */
+
+struct NoBodyChecker
+{
+	bool feed(std::string_view)
+	{
+		return true;
+	}
+	
+	bool finish()
+	{
+		return true;
+	}
+};
+
+// Checks the syntax of a JSON text as the JSON validators parse it : containers nest as deep as
+// the body allows, and a '\0' following the text ends it like the terminator of a C string.
+class JSONSyntaxChecker
+{
+public:
+	// Containers nested up to this depth are tracked without allocating.
+	constexpr static std::size_t inlineDepth = 256;
+	
+	bool feed(std::string_view chunk);
+	bool finish();
+	
+private:
+	enum class State : std::uint8_t
+	{
+		Value,
+		FirstValueOrEnd,
+		FirstKeyOrEnd,
+		Key,
+		Colon,
+		AfterValue,
+		String,
+		Escape,
+		Unicode,
+		Literal,
+		Minus,
+		Zero,
+		Integer,
+		Dot,
+		Fraction,
+		Exponent,
+		ExponentSign,
+		ExponentDigits,
+		Done,
+		Invalid,
+	};
+	
+	bool step(char c);
+	void push(bool object);
+	void pop();
+	bool inObject() const;
+	std::uint64_t& objectBits(std::size_t level);
+	
+	// One bit per nesting level, set for objects.
+	std::array<std::uint64_t, inlineDepth / 64> objects{};
+	std::vector<std::uint64_t> deeperObjects;
+	std::size_t depth = 0;
+	const char* literal = nullptr;
+	std::uint8_t progress = 0;
+	bool inKey = false;
+	State state = State::Value;
+};
+
+// One of many checkers, picked once the request's headers tell which one applies.
+template <typename ... Checkers>
+class AnyBodyChecker
+{
+public:
+	AnyBodyChecker() = default;
+	
+	template <std::size_t I>
+	explicit AnyBodyChecker(std::in_place_index_t<I> index) : checker{index}
+	{}
+	
+	bool feed(std::string_view chunk)
+	{
+		return std::visit([chunk](auto& c) {
+			return c.feed(chunk);
+		}, checker);
+	}
+	
+	bool finish()
+	{
+		return std::visit([](auto& c) {
+			return c.finish();
+		}, checker);
+	}
+	
+private:
+	std::variant<NoBodyChecker, Checkers...> checker;
+};
+
+namespace detail
+{
+	template <typename Validator, typename = void>
+	struct bodyCheckerOf
+	{
+		using type = NoBodyChecker;
+	};
+	template <typename Validator>
+	struct bodyCheckerOf<Validator, std::void_t<typename Validator::body_checker_type>>
+	{
+		using type = typename Validator::body_checker_type;
+	};
+	
+	template <typename Handler, typename = void>
+	struct handlerBodyChecker
+	{
+		using type = NoBodyChecker;
+	};
+	template <typename Handler>
+	struct handlerBodyChecker<Handler, std::void_t<typename Handler::body_checker_type>>
+	{
+		using type = typename Handler::body_checker_type;
+	};
+}
+
+#endif
@@ -0,0 +1,102 @@
+#ifndef CHAR_SCAN_HPP
+#define CHAR_SCAN_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/**
+ * Byte scanning helpers looking for either of two delimiters. Blocks of 32 (AVX2) or
+ * 16 (SSE2) bytes are compared at once when the target supports it, the remaining bytes
+ * are handled by a scalar loop. The instruction set is selected at compile time.
+ */
+
+namespace detail
+{
+#if defined(__AVX2__) || defined(__SSE2__)
+	inline unsigned int countTrailingZeros(std::uint32_t mask)
+	{
+		return static_cast<unsigned int>(__builtin_ctz(mask));
+	}
+#endif
+
+	// Invokes onMatch(position) for every byte of sv equal to a or b, in increasing order.
+	template <typename OnMatch>
+	void forEachOf(std::string_view sv, char a, char b, OnMatch&& onMatch)
+	{
+		const char* data = sv.data();
+		const std::size_t size = sv.size();
+		std::size_t i = 0;
+#if defined(__AVX2__)
+		const __m256i wideA = _mm256_set1_epi8(a);
+		const __m256i wideB = _mm256_set1_epi8(b);
+		for (; i + 32 <= size; i += 32) {
+			const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+			auto mask = static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(block, wideA), _mm256_cmpeq_epi8(block, wideB))));
+			for (; mask != 0; mask &= mask - 1) {
+				onMatch(i + countTrailingZeros(mask));
+			}
+		}
+#endif
+#if defined(__AVX2__) || defined(__SSE2__)
+		const __m128i narrowA = _mm_set1_epi8(a);
+		const __m128i narrowB = _mm_set1_epi8(b);
+		for (; i + 16 <= size; i += 16) {
+			const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+			auto mask = static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(block, narrowA), _mm_cmpeq_epi8(block, narrowB))));
+			for (; mask != 0; mask &= mask - 1) {
+				onMatch(i + countTrailingZeros(mask));
+			}
+		}
+#endif
+		for (; i < size; ++i) {
+			if (data[i] == a || data[i] == b) {
+				onMatch(i);
+			}
+		}
+	}
+
+	// Position of the first byte of sv equal to a or b, std::string_view::npos if there is none.
+	inline std::size_t findFirstOf(std::string_view sv, char a, char b)
+	{
+		const char* data = sv.data();
+		const std::size_t size = sv.size();
+		std::size_t i = 0;
+#if defined(__AVX2__)
+		const __m256i wideA = _mm256_set1_epi8(a);
+		const __m256i wideB = _mm256_set1_epi8(b);
+		for (; i + 32 <= size; i += 32) {
+			const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+			const auto mask = static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(block, wideA), _mm256_cmpeq_epi8(block, wideB))));
+			if (mask != 0) {
+				return i + countTrailingZeros(mask);
+			}
+		}
+#endif
+#if defined(__AVX2__) || defined(__SSE2__)
+		const __m128i narrowA = _mm_set1_epi8(a);
+		const __m128i narrowB = _mm_set1_epi8(b);
+		for (; i + 16 <= size; i += 16) {
+			const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+			const auto mask = static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(block, narrowA), _mm_cmpeq_epi8(block, narrowB))));
+			if (mask != 0) {
+				return i + countTrailingZeros(mask);
+			}
+		}
+#endif
+		for (; i < size; ++i) {
+			if (data[i] == a || data[i] == b) {
+				return i;
+			}
+		}
+		return std::string_view::npos;
+	}
+}
+
+#endif
@@ -0,0 +1,227 @@
+#include "Compression.hpp"
+#include <algorithm>
+#include <new>
+#include <utility>
+#include <vector>
+#include <zlib.h>
+
+namespace detail
+{
+	struct DeflateStream
+	{
+		DeflateStream(ContentCoding coding, int level) : coding{coding}, level{level}
+		{
+			// 16 more window bits select the gzip wrapper rather than zlib's.
+			const int windowBits = coding == ContentCoding::gzip ? 15 + 16 : 15;
+			if (deflateInit2(&stream, level, Z_DEFLATED, windowBits, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+				throw std::bad_alloc{};
+			}
+		}
+
+		~DeflateStream()
+		{
+			deflateEnd(&stream);
+		}
+
+		DeflateStream(const DeflateStream&) = delete;
+		DeflateStream& operator=(const DeflateStream&) = delete;
+
+		z_stream stream{};
+		ContentCoding coding;
+		int level;
+	};
+}
+
+namespace
+{
+	// Idle streams kept by each thread, past which released streams are freed.
+	constexpr std::size_t pooledStreamCount = 8;
+
+	thread_local std::vector<std::unique_ptr<detail::DeflateStream>> pool;
+
+	std::unique_ptr<detail::DeflateStream> acquire(ContentCoding coding, int level)
+	{
+		const auto it = std::find_if(pool.begin(), pool.end(), [&](const auto& stream) {
+			return stream->coding == coding && stream->level == level;
+		});
+		if (it == pool.end()) {
+			return std::make_unique<detail::DeflateStream>(coding, level);
+		}
+		auto stream = std::move(*it);
+		pool.erase(it);
+		return stream;
+	}
+
+	void release(std::unique_ptr<detail::DeflateStream> stream)
+	{
+		// Resetting keeps the tables, the next response only clears them.
+		if (pool.size() < pooledStreamCount && deflateReset(&stream->stream) == Z_OK) {
+			pool.push_back(std::move(stream));
+		}
+	}
+
+	bool equalsIgnoringCase(std::string_view lhs, std::string_view rhs)
+	{
+		return lhs.size() == rhs.size() && std::equal(lhs.begin(), lhs.end(), rhs.begin(), [](char l, char r) {
+			return (l >= 'A' && l <= 'Z' ? l + ('a' - 'A') : l) == r;
+		});
+	}
+
+	std::string_view trim(std::string_view value)
+	{
+		const auto begin = value.find_first_not_of(" \t");
+		if (begin == std::string_view::npos) {
+			return {};
+		}
+		return value.substr(begin, value.find_last_not_of(" \t") - begin + 1);
+	}
+
+	// The weight of a "q=0.5" parameter, in thousandths. Malformed weights are ignored.
+	int parseWeight(std::string_view parameters)
+	{
+		while (!parameters.empty()) {
+			const auto separator = parameters.find(';');
+			const auto parameter = trim(parameters.substr(0, separator));
+			parameters = separator == std::string_view::npos ? std::string_view{} : parameters.substr(separator + 1);
+			if (parameter.size() < 3 || (parameter[0] != 'q' && parameter[0] != 'Q') || parameter[1] != '=') {
+				continue;
+			}
+			const auto value = parameter.substr(2);
+			if (value[0] != '0') {
+				return 1000;
+			}
+			int weight = 0;
+			int scale = 100;
+			for (std::size_t i = 2; i < value.size() && i < 5 && value[1] == '.'; ++i) {
+				if (value[i] < '0' || value[i] > '9') {
+					return 1000;
+				}
+				weight += (value[i] - '0') * scale;
+				scale /= 10;
+			}
+			return weight;
+		}
+		return 1000;
+	}
+}
+
+ContentCoding negotiateContentCoding(std::string_view acceptEncoding)
+{
+	// Unlisted codings take the weight of "*", if any.
+	int gzip = -1;
+	int deflate = -1;
+	int any = 0;
+	while (!acceptEncoding.empty()) {
+		const auto separator = acceptEncoding.find(',');
+		const auto element = acceptEncoding.substr(0, separator);
+		acceptEncoding = separator == std::string_view::npos ? std::string_view{} : acceptEncoding.substr(separator + 1);
+		const auto parametersStart = element.find(';');
+		const auto coding = trim(element.substr(0, parametersStart));
+		const int weight = parametersStart == std::string_view::npos ? 1000 : parseWeight(element.substr(parametersStart + 1));
+		if (equalsIgnoringCase(coding, "gzip") || equalsIgnoringCase(coding, "x-gzip")) {
+			gzip = weight;
+		} else if (equalsIgnoringCase(coding, "deflate")) {
+			deflate = weight;
+		} else if (coding == "*") {
+			any = weight;
+		}
+	}
+	gzip = gzip < 0 ? any : gzip;
+	deflate = deflate < 0 ? any : deflate;
+	if (gzip > 0 && gzip >= deflate) {
+		return ContentCoding::gzip;
+	}
+	if (deflate > 0) {
+		return ContentCoding::deflate;
+	}
+	return ContentCoding::identity;
+}
+
+std::string_view contentCodingName(ContentCoding coding)
+{
+	switch (coding) {
+		case ContentCoding::gzip:
+			return "gzip";
+		case ContentCoding::deflate:
+			return "deflate";
+		default:
+			return {};
+	}
+}
+
+Compressor::Compressor(ContentCoding coding, int level) : stream{acquire(coding, level)}
+{}
+
+Compressor::~Compressor()
+{
+	if (stream) {
+		release(std::move(stream));
+	}
+}
+
+Compressor::Compressor(Compressor&&) noexcept = default;
+
+Compressor& Compressor::operator=(Compressor&& other) noexcept
+{
+	if (this != &other) {
+		if (stream) {
+			release(std::move(stream));
+		}
+		stream = std::move(other.stream);
+	}
+	return *this;
+}
+
+void Compressor::compress(std::string_view input, std::string& out, bool finish)
+{
+	auto& z = stream->stream;
+	z.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+	z.avail_in = static_cast<uInt>(input.size());
+	do {
+		const std::size_t offset = out.size();
+		const std::size_t room = std::max<std::size_t>(deflateBound(&z, z.avail_in), 64);
+		out.resize(offset + room);
+		z.next_out = reinterpret_cast<Bytef*>(&out[offset]);
+		z.avail_out = static_cast<uInt>(room);
+		deflate(&z, finish ? Z_FINISH : Z_SYNC_FLUSH);
+		out.resize(offset + room - z.avail_out);
+	} while (z.avail_out == 0);
+}
+
+bool compressBody(std::string& body, ContentCoding coding, int level)
+{
+	// Reused by every body of the thread, like the serialization buffer.
+	thread_local std::string buffer;
+	buffer.clear();
+	Compressor{coding, level}.compress(body, buffer, true);
+	if (buffer.size() >= body.size()) {
+		return false;
+	}
+	// The buffer keeps the uncompressed body's allocation for the next one.
+	body.swap(buffer);
+	if (buffer.capacity() > 1024 * 1024) {
+		std::string{}.swap(buffer);
+	}
+	return true;
+}
+
+std::shared_ptr<const SharedBody> SharedBody::compressed(ContentCoding coding, int level) const
+{
+	auto& variant = variants[coding == ContentCoding::gzip ? 0 : 1];
+	{
+		std::lock_guard<std::mutex> lock{mutex};
+		if (variant.body && variant.level == level) {
+			return *variant.body;
+		}
+	}
+	// Compressed out of the lock, a copy compressing the same variant meanwhile makes the same bytes.
+	std::string compressedBody{body};
+	std::shared_ptr<const SharedBody> result;
+	if (compressBody(compressedBody, coding, level)) {
+		result = std::make_shared<const SharedBody>(std::move(compressedBody));
+	}
+	std::lock_guard<std::mutex> lock{mutex};
+	variant.level = level;
+	variant.body = result;
+	return result;
+}
@@ -0,0 +1,102 @@
+#ifndef COMPRESSION_HPP
+#define COMPRESSION_HPP
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+
+/**
+ * Response compression with zlib, negotiated through Accept-Encoding.
+ *
+ * Deflate streams allocate a few hundred KiB of window and hash tables, so they are
+ * pooled per thread : a Compressor takes an idle stream of its thread's pool and resets
+ * it back into the pool when it is destroyed, instead of allocating new tables for
+ * every response. A Compressor may be fed many times, each input is flushed so that the
+ * batches of a streamed body can be sent as soon as they are compressed.
+ */
+
+enum class ContentCoding
+{
+	identity,
+	gzip,
+	// The zlib format, as HTTP defines it.
+	deflate
+};
+
+struct CompressionOptions
+{
+	// Smaller bodies are sent as they are, compressing them would save less than it costs.
+	std::size_t threshold = 1024;
+	// zlib's level, from 1 (fastest) to 9 (smallest).
+	int level = 6;
+};
+
+// The coding the client prefers among gzip and deflate, identity when it accepts neither.
+ContentCoding negotiateContentCoding(std::string_view acceptEncoding);
+
+// The Content-Encoding value of coding, empty for identity.
+std::string_view contentCodingName(ContentCoding coding);
+
+namespace detail
+{
+	struct DeflateStream;
+}
+
+class Compressor
+{
+public:
+	Compressor(ContentCoding coding, int level);
+	~Compressor();
+
+	Compressor(Compressor&&) noexcept;
+	Compressor& operator=(Compressor&&) noexcept;
+
+	// Appends the compressed input to out, finish ends the stream after it.
+	void compress(std::string_view input, std::string& out, bool finish);
+
+private:
+	std::unique_ptr<detail::DeflateStream> stream;
+};
+
+// Compresses a whole body in place, unless compressing it doesn't make it smaller.
+bool compressBody(std::string& body, ContentCoding coding, int level);
+
+// A whole body shared by the copies of a response (e.g. the cached ones). It keeps what it was
+// compressed into, so that each coding is only compressed once whatever the number of copies.
+class SharedBody
+{
+public:
+	explicit SharedBody(std::string content) : body{std::move(content)}
+	{}
+	
+	SharedBody(const SharedBody&) = delete;
+	SharedBody& operator=(const SharedBody&) = delete;
+	
+	const std::string& content() const
+	{
+		return body;
+	}
+	
+	// The content compressed with coding, null when compressing doesn't make it smaller. Only the
+	// variant of the latest level is kept.
+	std::shared_ptr<const SharedBody> compressed(ContentCoding coding, int level) const;
+	
+private:
+	struct Variant
+	{
+		int level = 0;
+		// Empty until compressed, null when compressing doesn't pay.
+		std::optional<std::shared_ptr<const SharedBody>> body;
+	};
+	
+	std::string body;
+	mutable std::mutex mutex;
+	// One for gzip, one for deflate.
+	mutable std::array<Variant, 2> variants;
+};
+
+#endif
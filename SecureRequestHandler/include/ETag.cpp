@@ -0,0 +1,138 @@
+#include "ETag.hpp"
+#include <cstddef>
+#include <cstring>
+
+namespace
+{
+	constexpr std::uint64_t prime1 = 0x9E3779B185EBCA87ULL;
+	constexpr std::uint64_t prime2 = 0xC2B2AE3D27D4EB4FULL;
+	constexpr std::uint64_t prime3 = 0x165667B19E3779F9ULL;
+	constexpr std::uint64_t prime4 = 0x85EBCA77C2B2AE63ULL;
+	constexpr std::uint64_t prime5 = 0x27D4EB2F165667C5ULL;
+
+	std::uint64_t rotateLeft(std::uint64_t value, int bits)
+	{
+		return (value << bits) | (value >> (64 - bits));
+	}
+
+	std::uint64_t read64(const char* data)
+	{
+		std::uint64_t value;
+		std::memcpy(&value, data, sizeof(value));
+		return value;
+	}
+
+	std::uint32_t read32(const char* data)
+	{
+		std::uint32_t value;
+		std::memcpy(&value, data, sizeof(value));
+		return value;
+	}
+
+	std::uint64_t mixRound(std::uint64_t accumulator, std::uint64_t input)
+	{
+		accumulator += input * prime2;
+		return rotateLeft(accumulator, 31) * prime1;
+	}
+
+	std::uint64_t mergeRound(std::uint64_t hash, std::uint64_t accumulator)
+	{
+		hash ^= mixRound(0, accumulator);
+		return hash * prime1 + prime4;
+	}
+
+	bool isWhitespace(char c)
+	{
+		return c == ' ' || c == '\t';
+	}
+}
+
+namespace detail
+{
+	std::uint64_t xxHash64(std::string_view data, std::uint64_t seed)
+	{
+		const char* it = data.data();
+		const char* const end = it + data.size();
+		std::uint64_t hash;
+		if (data.size() >= 32) {
+			std::uint64_t v1 = seed + prime1 + prime2;
+			std::uint64_t v2 = seed + prime2;
+			std::uint64_t v3 = seed;
+			std::uint64_t v4 = seed - prime1;
+			for (const char* const limit = end - 32; it <= limit; it += 32) {
+				v1 = mixRound(v1, read64(it));
+				v2 = mixRound(v2, read64(it + 8));
+				v3 = mixRound(v3, read64(it + 16));
+				v4 = mixRound(v4, read64(it + 24));
+			}
+			hash = rotateLeft(v1, 1) + rotateLeft(v2, 7) + rotateLeft(v3, 12) + rotateLeft(v4, 18);
+			hash = mergeRound(hash, v1);
+			hash = mergeRound(hash, v2);
+			hash = mergeRound(hash, v3);
+			hash = mergeRound(hash, v4);
+		} else {
+			hash = seed + prime5;
+		}
+		hash += static_cast<std::uint64_t>(data.size());
+		for (; end - it >= 8; it += 8) {
+			hash ^= mixRound(0, read64(it));
+			hash = rotateLeft(hash, 27) * prime1 + prime4;
+		}
+		if (end - it >= 4) {
+			hash ^= static_cast<std::uint64_t>(read32(it)) * prime1;
+			hash = rotateLeft(hash, 23) * prime2 + prime3;
+			it += 4;
+		}
+		for (; it != end; ++it) {
+			hash ^= static_cast<std::uint64_t>(static_cast<unsigned char>(*it)) * prime5;
+			hash = rotateLeft(hash, 11) * prime1;
+		}
+		hash ^= hash >> 33;
+		hash *= prime2;
+		hash ^= hash >> 29;
+		hash *= prime3;
+		hash ^= hash >> 32;
+		return hash;
+	}
+}
+
+std::string makeETag(std::string_view body)
+{
+	constexpr char digits[] = "0123456789abcdef";
+	const std::uint64_t hash = detail::xxHash64(body);
+	std::string etag(18, '"');
+	for (std::size_t i = 0; i < 16; ++i) {
+		etag[16 - i] = digits[(hash >> (i * 4)) & 0xF];
+	}
+	return etag;
+}
+
+bool matchesIfNoneMatch(std::string_view ifNoneMatch, std::string_view etag)
+{
+	std::size_t i = 0;
+	const std::size_t size = ifNoneMatch.size();
+	while (i < size) {
+		if (isWhitespace(ifNoneMatch[i]) || ifNoneMatch[i] == ',') {
+			++i;
+			continue;
+		}
+		if (ifNoneMatch[i] == '*') {
+			return true;
+		}
+		if (ifNoneMatch.compare(i, 2, "W/") == 0) {
+			i += 2;
+		}
+		if (i >= size || ifNoneMatch[i] != '"') {
+			return false;
+		}
+		const auto closing = ifNoneMatch.find('"', i + 1);
+		if (closing == std::string_view::npos) {
+			return false;
+		}
+		if (ifNoneMatch.substr(i, closing + 1 - i) == etag) {
+			return true;
+		}
+		i = closing + 1;
+	}
+	return false;
+}
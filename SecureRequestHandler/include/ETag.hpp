@@ -0,0 +1,43 @@
+#ifndef ETAG_HPP
+#define ETAG_HPP
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+/**
+ * Entity tags of serialized bodies, so that clients polling an unchanged resource are
+ * answered 304 Not Modified instead of downloading it again.
+ *
+ * The tag is a strong validator : a 64 bits xxHash of the body, which is fast enough to
+ * run on every response but is not cryptographic. It identifies a representation, it
+ * doesn't authenticate it.
+ */
+
+// Wraps the serializer of an ETagOutputDesc, request adapters tag the bodies it produces.
+template <typename Serializer>
+struct ETagSerializer : Serializer
+{
+	using serializer_type = Serializer;
+};
+
+namespace detail
+{
+	template <typename T>
+	struct isETagSerializer : std::false_type {};
+	template <typename Serializer>
+	struct isETagSerializer<ETagSerializer<Serializer>> : std::true_type {};
+
+	// XXH64, bytes are read in the host's order.
+	std::uint64_t xxHash64(std::string_view data, std::uint64_t seed = 0);
+}
+
+// The strong entity tag of body, e.g. "\"0123456789abcdef\"".
+std::string makeETag(std::string_view body);
+
+// Whether an If-None-Match value, "*" or a list of entity tags, matches etag. Entity tags
+// are compared weakly, as If-None-Match requires : W/"x" matches "x".
+bool matchesIfNoneMatch(std::string_view ifNoneMatch, std::string_view etag);
+
+#endif
@@ -1,58 +1,126 @@
 #include "GenericSerializer.hpp"
+#include <array>
+#include <charconv>
+#include <clocale>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
 #include <string>
+#include <type_traits>
+
+namespace
+{
+#if !defined(__cpp_lib_to_chars)
+	// Standard libraries without floating point std::to_chars (libc++ before
+	// macOS 13.3) fall back to snprintf with just enough digits to read back
+	// to the same value, written with '.' whatever the current C locale is.
+	template <typename T>
+	T readFloating(const char* str)
+	{
+		if constexpr (std::is_same_v<T, float>) {
+			return std::strtof(str, nullptr);
+		} else if constexpr (std::is_same_v<T, double>) {
+			return std::strtod(str, nullptr);
+		} else {
+			return std::strtold(str, nullptr);
+		}
+	}
+	
+	template <typename T>
+	void appendFloating(std::string& out, T v)
+	{
+		std::array<char, 64> buffer;
+		int size = 0;
+		for (int precision = std::numeric_limits<T>::digits10; precision <= std::numeric_limits<T>::max_digits10; ++precision) {
+			size = std::snprintf(buffer.data(), buffer.size(), "%.*Lg", precision, static_cast<long double>(v));
+			if (readFloating<T>(buffer.data()) == v) {
+				break;
+			}
+		}
+		const char decimalPoint = *std::localeconv()->decimal_point;
+		for (int i = 0; i < size; ++i) {
+			out += buffer[i] == decimalPoint ? '.' : buffer[i];
+		}
+	}
+#endif
+	
+	// Floating point values are written in their shortest round-trip representation.
+	template <typename T>
+	void appendNumber(std::string& out, T v)
+	{
+#if !defined(__cpp_lib_to_chars)
+		if constexpr (std::is_floating_point_v<T>) {
+			appendFloating(out, v);
+		} else
+#endif
+		{
+			std::array<char, 64> buffer;
+			const auto result = std::to_chars(buffer.data(), buffer.data() + buffer.size(), v);
+			out.append(buffer.data(), result.ptr);
+		}
+	}
+	
+	template <typename T>
+	std::string numberToString(T v)
+	{
+		std::string result;
+		appendNumber(result, v);
+		return result;
+	}
+}
 
 template <>
 std::string GenericSerialize<int>(const int& v)
 {
-	return std::to_string(v);
+	return numberToString(v);
 }
 
 template <>
 std::string GenericSerialize<long>(const long& v)
 {
-	return std::to_string(v);
+	return numberToString(v);
 }
 
 template <>
 std::string GenericSerialize<long long>(const long long& v)
 {
-	return std::to_string(v);
+	return numberToString(v);
 }
 
 template <>
 std::string GenericSerialize<unsigned int>(const unsigned int& v)
 {
-	return std::to_string(v);
+	return numberToString(v);
 }
 
 template <>
 std::string GenericSerialize<unsigned long>(const unsigned long& v)
 {
-	return std::to_string(v);
+	return numberToString(v);
 }
 
 template <>
 std::string GenericSerialize<unsigned long long>(const unsigned long long& v)
 {
-	return std::to_string(v);
+	return numberToString(v);
 }
 
 template <>
 std::string GenericSerialize<float>(const float& v)
 {
-	return std::to_string(v);
+	return numberToString(v);
 }
 
 template <>
 std::string GenericSerialize<double>(const double& v)
 {
-	return std::to_string(v);
+	return numberToString(v);
 }
 
 template <>
 std::string GenericSerialize<long double>(const long double& v)
 {
-	return std::to_string(v);
+	return numberToString(v);
 }
 
 template <>
@@ -66,3 +134,69 @@ std::string GenericSerialize<std::string_view>(const std::string_view& v)
 {
 	return std::string{v};
 }
+
+template <>
+void GenericSerializeInto<int>(std::string& out, const int& v)
+{
+	appendNumber(out, v);
+}
+
+template <>
+void GenericSerializeInto<long>(std::string& out, const long& v)
+{
+	appendNumber(out, v);
+}
+
+template <>
+void GenericSerializeInto<long long>(std::string& out, const long long& v)
+{
+	appendNumber(out, v);
+}
+
+template <>
+void GenericSerializeInto<unsigned int>(std::string& out, const unsigned int& v)
+{
+	appendNumber(out, v);
+}
+
+template <>
+void GenericSerializeInto<unsigned long>(std::string& out, const unsigned long& v)
+{
+	appendNumber(out, v);
+}
+
+template <>
+void GenericSerializeInto<unsigned long long>(std::string& out, const unsigned long long& v)
+{
+	appendNumber(out, v);
+}
+
+template <>
+void GenericSerializeInto<float>(std::string& out, const float& v)
+{
+	appendNumber(out, v);
+}
+
+template <>
+void GenericSerializeInto<double>(std::string& out, const double& v)
+{
+	appendNumber(out, v);
+}
+
+template <>
+void GenericSerializeInto<long double>(std::string& out, const long double& v)
+{
+	appendNumber(out, v);
+}
+
+template <>
+void GenericSerializeInto<std::string>(std::string& out, const std::string& v)
+{
+	out += v;
+}
+
+template <>
+void GenericSerializeInto<std::string_view>(std::string& out, const std::string_view& v)
+{
+	out += v;
+}
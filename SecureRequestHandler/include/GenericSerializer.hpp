@@ -34,6 +34,36 @@ std::string GenericSerialize<std::string>(const std::string&);
 template <>
 std::string GenericSerialize<std::string_view>(const std::string_view&);
 
+// Appends the serialized value to out. Defaults to GenericSerialize for user-defined types.
+template <typename T>
+void GenericSerializeInto(std::string& out, const T& v)
+{
+	out += GenericSerialize<T>(v);
+}
+
+template <>
+void GenericSerializeInto<int>(std::string&, const int&);
+template <>
+void GenericSerializeInto<long>(std::string&, const long&);
+template <>
+void GenericSerializeInto<long long>(std::string&, const long long&);
+template <>
+void GenericSerializeInto<unsigned int>(std::string&, const unsigned int&);
+template <>
+void GenericSerializeInto<unsigned long>(std::string&, const unsigned long&);
+template <>
+void GenericSerializeInto<unsigned long long>(std::string&, const unsigned long long&);
+template <>
+void GenericSerializeInto<float>(std::string&, const float&);
+template <>
+void GenericSerializeInto<double>(std::string&, const double&);
+template <>
+void GenericSerializeInto<long double>(std::string&, const long double&);
+template <>
+void GenericSerializeInto<std::string>(std::string&, const std::string&);
+template <>
+void GenericSerializeInto<std::string_view>(std::string&, const std::string_view&);
+
 template <typename T>
 struct GenericSerializer
 {
@@ -43,6 +73,11 @@ struct GenericSerializer
 	{
 		return GenericSerialize<T>(t);
 	}
+	
+	void operator()(const T& t, std::string& out) const
+	{
+		GenericSerializeInto<T>(out, t);
+	}
 };
 
 #endif
@@ -1,66 +1,128 @@
 #include "GenericValidator.hpp"
+#include <cerrno>
+#include <charconv>
+#include <clocale>
+#include <cstdlib>
+#include <string>
+#include <system_error>
+#include <type_traits>
+
+namespace
+{
+	// The whole input must be consumed, leading whitespace or '+' is not accepted
+	// and out of range values are rejected.
+	template <typename T>
+	std::optional<T> parseNumber(std::string_view sv)
+	{
+		T value{};
+		const char* last = sv.data() + sv.size();
+		const auto result = std::from_chars(sv.data(), last, value);
+		if (result.ec == std::errc{} && result.ptr == last) {
+			return value;
+		}
+		return std::nullopt;
+	}
+	
+#if !defined(__cpp_lib_to_chars)
+	// Standard libraries without floating point std::from_chars (libc++ before
+	// macOS 13.3) fall back to strtod with the same rules as above. The input is
+	// written with '.' whatever the current C locale is.
+	template <typename T>
+	T parseFloating(const char* str, char** end)
+	{
+		if constexpr (std::is_same_v<T, float>) {
+			return std::strtof(str, end);
+		} else if constexpr (std::is_same_v<T, double>) {
+			return std::strtod(str, end);
+		} else {
+			return std::strtold(str, end);
+		}
+	}
+	
+	template <typename T>
+	std::optional<T> parseFloatingNumber(std::string_view sv)
+	{
+		if (sv.empty() || sv.front() == '+' || sv.find_first_of(" \t\n\v\f\rxX") != std::string_view::npos) {
+			return std::nullopt;
+		}
+		std::string str{sv.data(), sv.size()};
+		const char decimalPoint = *std::localeconv()->decimal_point;
+		if (decimalPoint != '.') {
+			for (char& c : str) {
+				if (c == '.') {
+					c = decimalPoint;
+				}
+			}
+		}
+		char* end = nullptr;
+		errno = 0;
+		const T value = parseFloating<T>(str.c_str(), &end);
+		if (errno != ERANGE && end == str.c_str() + str.size()) {
+			return value;
+		}
+		return std::nullopt;
+	}
+#else
+	template <typename T>
+	std::optional<T> parseFloatingNumber(std::string_view sv)
+	{
+		return parseNumber<T>(sv);
+	}
+#endif
+}
 
 template <>
 std::optional<int> GenericValidate<int>(std::string_view sv)
 {
-	std::string str{sv.data(), sv.size()};
-	return std::stoi(str);
+	return parseNumber<int>(sv);
 }
 
 template <>
 std::optional<long> GenericValidate<long>(std::string_view sv)
 {
-	std::string str{sv.data(), sv.size()};
-	return std::stol(str);
+	return parseNumber<long>(sv);
 }
 
 template <>
 std::optional<long long> GenericValidate<long long>(std::string_view sv)
 {
-	std::string str{sv.data(), sv.size()};
-	return std::stoll(str);
+	return parseNumber<long long>(sv);
 }
 
 template <>
 std::optional<unsigned int> GenericValidate<unsigned int>(std::string_view sv)
 {
-	std::string str{sv.data(), sv.size()};
-	return static_cast<unsigned int>(std::stoul(str));
+	return parseNumber<unsigned int>(sv);
 }
 
 template <>
 std::optional<unsigned long> GenericValidate<unsigned long>(std::string_view sv)
 {
-	std::string str{sv.data(), sv.size()};
-	return std::stoul(str);
+	return parseNumber<unsigned long>(sv);
 }
 
 template <>
 std::optional<unsigned long long> GenericValidate<unsigned long long>(std::string_view sv)
 {
-	std::string str{sv.data(), sv.size()};
-	return std::stoull(str);
+	return parseNumber<unsigned long long>(sv);
 }
 
 template <>
 std::optional<float> GenericValidate<float>(std::string_view sv)
 {
-	std::string str{sv.data(), sv.size()};
-	return std::stof(str);
+	return parseFloatingNumber<float>(sv);
 }
 
 template <>
 std::optional<double> GenericValidate<double>(std::string_view sv)
 {
-	std::string str{sv.data(), sv.size()};
-	return std::stod(str);
+	return parseFloatingNumber<double>(sv);
 }
 
 template <>
 std::optional<long double> GenericValidate<long double>(std::string_view sv)
 {
-	std::string str{sv.data(), sv.size()};
-	return std::stold(str);
+	return parseFloatingNumber<long double>(sv);
 }
 
 template <>
@@ -0,0 +1,63 @@
+#ifndef HEADER_KEY_HPP
+#define HEADER_KEY_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+/**
+ * Header names known when the program is compiled, along with a hash of their lowercase
+ * spelling, so that a request's headers can be matched against all the names a handler
+ * reads in a single pass. Adapters may provide
+ *   template <typename ... Keys> static std::array<std::string_view, sizeof...(Keys)> getHeaders(const request_type&)
+ * to resolve the Keys (typestrings) together, getHeader is called for each of them otherwise.
+ */
+
+struct HeaderKey
+{
+	std::string_view name;
+	std::uint32_t hash;
+};
+
+template <typename ... Keys>
+struct HeaderKeyList {};
+
+namespace detail
+{
+	constexpr char toLowerASCII(char c)
+	{
+		return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+	}
+
+	// Case-insensitive FNV-1a, header names being ASCII.
+	constexpr std::uint32_t hashHeaderName(std::string_view name)
+	{
+		std::uint32_t hash = 2166136261u;
+		for (char c : name) {
+			hash ^= static_cast<unsigned char>(toLowerASCII(c));
+			hash *= 16777619u;
+		}
+		return hash;
+	}
+
+	constexpr bool equalHeaderNames(std::string_view lhs, std::string_view rhs)
+	{
+		if (lhs.size() != rhs.size()) {
+			return false;
+		}
+		for (std::size_t i = 0; i < lhs.size(); ++i) {
+			if (toLowerASCII(lhs[i]) != toLowerASCII(rhs[i])) {
+				return false;
+			}
+		}
+		return true;
+	}
+}
+
+template <typename Key>
+constexpr HeaderKey headerKey{
+	std::string_view{Key::data(), Key::size()},
+	detail::hashHeaderName(std::string_view{Key::data(), Key::size()})
+};
+
+#endif
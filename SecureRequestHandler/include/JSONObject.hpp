@@ -0,0 +1,64 @@
+#ifndef JSON_OBJECT_HPP
+#define JSON_OBJECT_HPP
+
+#include <optional>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+/**
+ * Describes the fields of a user-defined type once, for every JSON component working
+ * field by field (JSONSAXValidator, WriteJSON) :
+ *
+
+ template <>
+ struct JSONObject<Address>
+ {
+	 constexpr static auto fields = std::make_tuple(
+		 JSONField("number", &Address::number),
+		 JSONField("street", &Address::street)
+	 );
+ };
+
+ *
+ */
+
+template <typename T>
+struct JSONObject;
+
+template <typename Class, typename Member>
+struct JSONFieldDesc
+{
+	using class_type = Class;
+	using member_type = Member;
+
+	std::string_view name;
+	Member Class::* member;
+};
+
+template <typename Class, typename Member>
+constexpr JSONFieldDesc<Class, Member> JSONField(std::string_view name, Member Class::* member)
+{
+	return JSONFieldDesc<Class, Member>{name, member};
+}
+
+namespace detail
+{
+	template <typename T, typename = void>
+	struct isJSONObject : std::false_type {};
+	template <typename T>
+	struct isJSONObject<T, std::void_t<decltype(JSONObject<T>::fields)>> : std::true_type {};
+
+	template <typename T>
+	struct isStdVector : std::false_type {};
+	template <typename T, typename Allocator>
+	struct isStdVector<std::vector<T, Allocator>> : std::true_type {};
+
+	template <typename T>
+	struct isStdOptional : std::false_type {};
+	template <typename T>
+	struct isStdOptional<std::optional<T>> : std::true_type {};
+}
+
+#endif
@@ -0,0 +1,99 @@
+#include "BlockSizing.hpp"
+#include "JSONPool.hpp"
+#include <cstddef>
+#include <memory>
+#include <optional>
+
+namespace
+{
+	// Room for the bookkeeping the allocator keeps at the start of its first chunk.
+	constexpr std::size_t blockOverhead = 256;
+	
+	detail::BlockSizing sizing{1024 * 1024};
+	
+	// A MemoryPoolAllocator whose first chunk is a block kept across resets.
+	class JSONArena
+	{
+	public:
+		JSONPoolAllocator& allocator()
+		{
+			if (!pool) {
+				if (!block) {
+					block = std::make_unique<char[]>(blockSize);
+				}
+				pool.emplace(block.get(), blockSize);
+			}
+			return *pool;
+		}
+		
+		void reset()
+		{
+			if (!pool) {
+				return;
+			}
+			const std::size_t size = sizing.nextSize(blockSize, pool->Size() + blockOverhead);
+			// Frees the chunks allocated past the block.
+			pool.reset();
+			if (size != blockSize) {
+				blockSize = size;
+				block.reset();
+			}
+		}
+		
+	private:
+		std::unique_ptr<char[]> block;
+		std::size_t blockSize = detail::BlockSizing::initialBlockSize;
+		std::optional<JSONPoolAllocator> pool;
+	};
+}
+
+namespace detail
+{
+	struct JSONPool
+	{
+		JSONArena values;
+		JSONArena stacks;
+		std::size_t leases = 0;
+	};
+}
+
+void setJSONPoolHighWaterMark(std::size_t bytes)
+{
+	sizing.setHighWaterMark(bytes);
+}
+
+std::size_t getJSONPoolHighWaterMark()
+{
+	return sizing.getHighWaterMark();
+}
+
+JSONPoolLease::JSONPoolLease() : pool{[]() -> detail::JSONPool& {
+	thread_local detail::JSONPool threadPool;
+	return threadPool;
+}()}
+{
+	++pool.leases;
+}
+
+JSONPoolLease::~JSONPoolLease()
+{
+	if (--pool.leases == 0) {
+		pool.values.reset();
+		pool.stacks.reset();
+	}
+}
+
+JSONPoolAllocator& JSONPoolLease::allocator()
+{
+	return pool.values.allocator();
+}
+
+JSONPoolAllocator& JSONPoolLease::stackAllocator()
+{
+	return pool.stacks.allocator();
+}
+
+DetachedJSON::DetachedJSON(const allocator_type& allocator)
+: valueAllocator{allocator.resource()->allocate(valueChunkCapacity, alignof(std::max_align_t)), valueChunkCapacity}
+, stackAllocator{allocator.resource()->allocate(stackChunkCapacity, alignof(std::max_align_t)), stackChunkCapacity}
+{}
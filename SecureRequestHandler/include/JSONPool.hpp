@@ -0,0 +1,81 @@
+#ifndef JSON_POOL_HPP
+#define JSON_POOL_HPP
+
+#include <cstddef>
+#include <memory_resource>
+#include <rapidjson/allocators.h>
+#include <rapidjson/document.h>
+
+/**
+ * Per-thread memory reused by the JSON documents, readers and writers of the library.
+ *
+ * A JSONPoolLease grants access to the calling thread's pools for as long as it lives. Leases
+ * nest, since the documents validated for a handler are still alive while its response is
+ * serialized, and the pools are reset when the outermost lease ends. Resetting keeps the
+ * pools' blocks for the next requests : a request which needed more grows them, up to the
+ * high-water mark past which the extra memory is freed instead of retained.
+ *
+ * A document kept while the thread serves other requests (e.g. by a request waiting for its
+ * body) would keep a lease, and the pools would grow for as long as the thread is busy. Such
+ * documents are DetachedJSON instead, whose memory is their own.
+ */
+
+// The most memory retained by each pool of each thread between requests, 1 MiB by default.
+void setJSONPoolHighWaterMark(std::size_t bytes);
+std::size_t getJSONPoolHighWaterMark();
+
+using JSONPoolAllocator = rapidjson::MemoryPoolAllocator<>;
+using PooledJSONDocument = rapidjson::GenericDocument<rapidjson::UTF8<>, JSONPoolAllocator, JSONPoolAllocator>;
+
+namespace detail
+{
+	struct JSONPool;
+}
+
+class JSONPoolLease
+{
+public:
+	JSONPoolLease();
+	~JSONPoolLease();
+	
+	JSONPoolLease(const JSONPoolLease&) = delete;
+	JSONPoolLease& operator=(const JSONPoolLease&) = delete;
+	
+	// Allocator for the values of documents
+	JSONPoolAllocator& allocator();
+	// Allocator for the stacks of documents, readers and writers
+	JSONPoolAllocator& stackAllocator();
+	
+private:
+	detail::JSONPool& pool;
+};
+
+// A document allocating from the thread's pools, holding its lease until it is destroyed.
+struct PooledJSON
+{
+	constexpr static std::size_t stackCapacity = 1024;
+	
+	JSONPoolLease lease;
+	PooledJSONDocument document{&lease.allocator(), stackCapacity, &lease.stackAllocator()};
+};
+
+// A document which doesn't use the thread's pools. Its first chunks come from allocator (e.g. the
+// arena of a RequestContext), the next ones from the heap, and are released along with it.
+struct DetachedJSON
+{
+	using allocator_type = std::pmr::polymorphic_allocator<char>;
+	
+	constexpr static std::size_t valueChunkCapacity = 8 * 1024;
+	constexpr static std::size_t stackChunkCapacity = 2 * 1024;
+	
+	explicit DetachedJSON(const allocator_type& allocator);
+	
+	DetachedJSON(const DetachedJSON&) = delete;
+	DetachedJSON& operator=(const DetachedJSON&) = delete;
+	
+	JSONPoolAllocator valueAllocator;
+	JSONPoolAllocator stackAllocator;
+	PooledJSONDocument document{&valueAllocator, PooledJSON::stackCapacity, &stackAllocator};
+};
+
+#endif
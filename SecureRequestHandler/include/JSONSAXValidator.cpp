@@ -0,0 +1,235 @@
+#include "JSONSAXValidator.hpp"
+#include <array>
+#include "JSONPool.hpp"
+#include <rapidjson/memorystream.h>
+#include <rapidjson/reader.h>
+#include <rapidjson/stream.h>
+
+namespace
+{
+	// Nesting deeper than this is rejected rather than followed.
+	constexpr std::size_t maxDepth = 64;
+	
+	using JSONPoolReader = rapidjson::GenericReader<rapidjson::UTF8<>, rapidjson::UTF8<>, JSONPoolAllocator>;
+	
+	class JSONSAXHandler
+	{
+	public:
+		using Ch = char;
+		
+		explicit JSONSAXHandler(JSONSAXSlot root) : pending{root} {}
+		
+		bool Null()
+		{
+			if (skipValue()) {
+				return true;
+			}
+			const auto slot = nextSlot();
+			return slot.type->onNull && slot.type->onNull(slot.target);
+		}
+		
+		bool Bool(bool v)
+		{
+			if (skipValue()) {
+				return true;
+			}
+			const auto slot = resolve(nextSlot());
+			return slot.type->onBool && slot.type->onBool(slot.target, v);
+		}
+		
+		bool Int(int v)
+		{
+			return Int64(v);
+		}
+		
+		bool Uint(unsigned v)
+		{
+			return Uint64(v);
+		}
+		
+		bool Int64(std::int64_t v)
+		{
+			if (skipValue()) {
+				return true;
+			}
+			const auto slot = resolve(nextSlot());
+			return slot.type->onInt64 && slot.type->onInt64(slot.target, v);
+		}
+		
+		bool Uint64(std::uint64_t v)
+		{
+			if (skipValue()) {
+				return true;
+			}
+			const auto slot = resolve(nextSlot());
+			return slot.type->onUint64 && slot.type->onUint64(slot.target, v);
+		}
+		
+		bool Double(double v)
+		{
+			if (skipValue()) {
+				return true;
+			}
+			const auto slot = resolve(nextSlot());
+			return slot.type->onDouble && slot.type->onDouble(slot.target, v);
+		}
+		
+		bool RawNumber(const Ch*, rapidjson::SizeType, bool)
+		{
+			return false;
+		}
+		
+		bool String(const Ch* str, rapidjson::SizeType length, bool copy)
+		{
+			if (skipValue()) {
+				return true;
+			}
+			const auto slot = resolve(nextSlot());
+			if (copy && slot.type->borrowsStrings) {
+				return false;
+			}
+			return slot.type->onString && slot.type->onString(slot.target, std::string_view{str, length});
+		}
+		
+		bool StartObject()
+		{
+			if (skipContainer()) {
+				return true;
+			}
+			return push(JSONSAXKind::Object);
+		}
+		
+		bool Key(const Ch* str, rapidjson::SizeType length, bool)
+		{
+			if (skipDepth > 0) {
+				return true;
+			}
+			auto& frame = frames[depth - 1];
+			const int index = frame.slot.type->onKey(frame.slot.target, std::string_view{str, length}, pending);
+			if (index < 0) {
+				skipNext = true;
+				return true;
+			}
+			const auto bit = std::uint64_t{1} << index;
+			if (frame.seenFields & bit) {
+				return false;
+			}
+			frame.seenFields |= bit;
+			return true;
+		}
+		
+		bool EndObject(rapidjson::SizeType)
+		{
+			if (skipDepth > 0) {
+				--skipDepth;
+				return true;
+			}
+			const auto& frame = frames[--depth];
+			const auto required = frame.slot.type->requiredFields;
+			return (frame.seenFields & required) == required;
+		}
+		
+		bool StartArray()
+		{
+			if (skipContainer()) {
+				return true;
+			}
+			return push(JSONSAXKind::Array);
+		}
+		
+		bool EndArray(rapidjson::SizeType)
+		{
+			if (skipDepth > 0) {
+				--skipDepth;
+				return true;
+			}
+			--depth;
+			return true;
+		}
+		
+	private:
+		struct Frame
+		{
+			JSONSAXSlot slot;
+			std::uint64_t seenFields;
+		};
+		
+		// The value of an unknown key is skipped, whatever its nesting.
+		bool skipValue()
+		{
+			if (skipDepth > 0) {
+				return true;
+			}
+			if (skipNext) {
+				skipNext = false;
+				return true;
+			}
+			return false;
+		}
+		
+		bool skipContainer()
+		{
+			if (skipDepth > 0 || skipNext) {
+				skipNext = false;
+				++skipDepth;
+				return true;
+			}
+			return false;
+		}
+		
+		// Where the upcoming value goes : a new element in arrays, the field named by the last key in objects.
+		JSONSAXSlot nextSlot()
+		{
+			if (depth > 0 && frames[depth - 1].slot.type->kind == JSONSAXKind::Array) {
+				return frames[depth - 1].slot.type->onElement(frames[depth - 1].slot.target);
+			}
+			return pending;
+		}
+		
+		// Engages optionals, a null value is the only one leaving them empty.
+		static JSONSAXSlot resolve(JSONSAXSlot slot)
+		{
+			while (slot.type->kind == JSONSAXKind::Optional) {
+				slot = slot.type->onElement(slot.target);
+			}
+			return slot;
+		}
+		
+		bool push(JSONSAXKind kind)
+		{
+			const auto slot = resolve(nextSlot());
+			if (slot.type->kind != kind || depth == maxDepth) {
+				return false;
+			}
+			frames[depth++] = Frame{slot, 0};
+			return true;
+		}
+		
+		std::array<Frame, maxDepth> frames;
+		std::size_t depth = 0;
+		std::size_t skipDepth = 0;
+		bool skipNext = false;
+		JSONSAXSlot pending;
+	};
+}
+
+bool detail::parseJSONInto(std::string_view sv, JSONSAXSlot target)
+{
+	JSONSAXHandler handler{target};
+	rapidjson::MemoryStream stream{sv.data(), sv.size()};
+	JSONPoolLease lease;
+	JSONPoolReader reader{&lease.stackAllocator()};
+	const auto result = reader.Parse<rapidjson::kParseIterativeFlag>(stream, handler);
+	// A '\0' inside the input reads as the end of the stream, whatever follows must not be ignored.
+	return !result.IsError() && stream.Tell() == sv.size();
+}
+
+bool detail::parseJSONInsituInto(char* buffer, std::size_t size, JSONSAXSlot target)
+{
+	JSONSAXHandler handler{target};
+	rapidjson::InsituStringStream stream{buffer};
+	JSONPoolLease lease;
+	JSONPoolReader reader{&lease.stackAllocator()};
+	const auto result = reader.Parse<rapidjson::kParseInsituFlag | rapidjson::kParseIterativeFlag>(stream, handler);
+	return !result.IsError() && stream.Tell() == size;
+}
@@ -0,0 +1,247 @@
+#ifndef JSON_SAX_VALIDATOR_HPP
+#define JSON_SAX_VALIDATOR_HPP
+
+#include "BodyChecker.hpp"
+#include <cstddef>
+#include <cstdint>
+#include "JSONObject.hpp"
+#include <limits>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ * JSONSAXValidator fills a T in a single pass over the input, straight from rapidjson's
+ * SAX events : no DOM is built, no member is searched for and the parse stops on the first
+ * value which doesn't fit its field.
+ *
+ * Types describe their fields once by specializing JSONObject :
+ *
+
+ template <>
+ struct JSONObject<Address>
+ {
+	 constexpr static auto fields = std::make_tuple(
+		 JSONField("number", &Address::number),
+		 JSONField("street", &Address::street)
+	 );
+ };
+
+ *
+ * Fields can be bool, integral and floating point numbers, std::string, std::vector of a
+ * supported type, other types described by JSONObject, and std::optional of any of these.
+ * std::string_view fields are supported by JSONSAXInsituValidator only, they are rejected
+ * when the input isn't parsed in place since the parser's copies wouldn't outlive it.
+ * Every field is required unless it is a std::optional, unknown keys are skipped, duplicate
+ * keys are rejected and integral fields reject values that aren't integers within range.
+ */
+
+struct JSONSAXType;
+
+// The value a SAX event is about to fill and how to fill it
+struct JSONSAXSlot
+{
+	void* target;
+	const JSONSAXType* type;
+};
+
+enum class JSONSAXKind
+{
+	Scalar,
+	Object,
+	Array,
+	Optional,
+};
+
+// Type-erased operations on one C++ type, a null event handler means the event doesn't fit the type.
+struct JSONSAXType
+{
+	JSONSAXKind kind;
+	bool (*onNull)(void*);
+	bool (*onBool)(void*, bool);
+	bool (*onInt64)(void*, std::int64_t);
+	bool (*onUint64)(void*, std::uint64_t);
+	bool (*onDouble)(void*, double);
+	bool (*onString)(void*, std::string_view);
+	// Objects : finds the field named key, returns its index or -1 when the key is unknown.
+	int (*onKey)(void*, std::string_view, JSONSAXSlot&);
+	std::uint64_t requiredFields;
+	// Arrays : appends an element and returns it. Optionals : engages the value and returns it.
+	JSONSAXSlot (*onElement)(void*);
+	// Strings : the value keeps a view on the input, which is only possible when parsing in place.
+	bool borrowsStrings;
+};
+
+template <typename T>
+const JSONSAXType& jsonSAXType();
+
+namespace detail
+{
+	template <typename T>
+	bool assignIntegral(void* target, std::int64_t v)
+	{
+		if constexpr (std::is_unsigned_v<T>) {
+			if (v < 0 || static_cast<std::uint64_t>(v) > std::numeric_limits<T>::max()) {
+				return false;
+			}
+		} else if (v < std::numeric_limits<T>::min() || v > std::numeric_limits<T>::max()) {
+			return false;
+		}
+		*static_cast<T*>(target) = static_cast<T>(v);
+		return true;
+	}
+
+	template <typename T>
+	bool assignIntegral(void* target, std::uint64_t v)
+	{
+		if (v > static_cast<std::uint64_t>(std::numeric_limits<T>::max())) {
+			return false;
+		}
+		*static_cast<T*>(target) = static_cast<T>(v);
+		return true;
+	}
+
+	template <typename T, std::size_t ... Is>
+	int findJSONField(void* object, std::string_view key, JSONSAXSlot& slot, std::index_sequence<Is...>)
+	{
+		int index = -1;
+		((std::get<Is>(JSONObject<T>::fields).name == key
+			? (slot = JSONSAXSlot{
+				&(static_cast<T*>(object)->*std::get<Is>(JSONObject<T>::fields).member),
+				&jsonSAXType<typename std::decay_t<decltype(std::get<Is>(JSONObject<T>::fields))>::member_type>()
+			}, index = static_cast<int>(Is), true)
+			: false) || ...);
+		return index;
+	}
+
+	template <typename T, std::size_t ... Is>
+	constexpr std::uint64_t requiredJSONFields(std::index_sequence<Is...>)
+	{
+		return ((isStdOptional<typename std::decay_t<decltype(std::get<Is>(JSONObject<T>::fields))>::member_type>::value ? std::uint64_t{0} : std::uint64_t{1} << Is) | ... | std::uint64_t{0});
+	}
+
+	template <typename T>
+	constexpr JSONSAXType makeJSONSAXType()
+	{
+		JSONSAXType type{JSONSAXKind::Scalar, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, 0, nullptr, false};
+		if constexpr (std::is_same_v<T, bool>) {
+			type.onBool = [](void* target, bool v) {
+				*static_cast<T*>(target) = v;
+				return true;
+			};
+		} else if constexpr (std::is_integral_v<T>) {
+			type.onInt64 = [](void* target, std::int64_t v) {
+				return assignIntegral<T>(target, v);
+			};
+			type.onUint64 = [](void* target, std::uint64_t v) {
+				return assignIntegral<T>(target, v);
+			};
+		} else if constexpr (std::is_floating_point_v<T>) {
+			type.onInt64 = [](void* target, std::int64_t v) {
+				*static_cast<T*>(target) = static_cast<T>(v);
+				return true;
+			};
+			type.onUint64 = [](void* target, std::uint64_t v) {
+				*static_cast<T*>(target) = static_cast<T>(v);
+				return true;
+			};
+			type.onDouble = [](void* target, double v) {
+				// Converting a double outside of the range of T is undefined, reject it instead.
+				if constexpr (std::numeric_limits<T>::max() < std::numeric_limits<double>::max()) {
+					if (v < std::numeric_limits<T>::lowest() || v > std::numeric_limits<T>::max()) {
+						return false;
+					}
+				}
+				*static_cast<T*>(target) = static_cast<T>(v);
+				return true;
+			};
+		} else if constexpr (std::is_same_v<T, std::string>) {
+			type.onString = [](void* target, std::string_view v) {
+				static_cast<T*>(target)->assign(v.data(), v.size());
+				return true;
+			};
+		} else if constexpr (std::is_same_v<T, std::string_view>) {
+			type.onString = [](void* target, std::string_view v) {
+				*static_cast<T*>(target) = v;
+				return true;
+			};
+			type.borrowsStrings = true;
+		} else if constexpr (isStdOptional<T>::value) {
+			type.kind = JSONSAXKind::Optional;
+			type.onNull = [](void* target) {
+				static_cast<T*>(target)->reset();
+				return true;
+			};
+			type.onElement = [](void* target) {
+				auto& value = static_cast<T*>(target)->emplace();
+				return JSONSAXSlot{&value, &jsonSAXType<typename T::value_type>()};
+			};
+		} else if constexpr (isStdVector<T>::value) {
+			type.kind = JSONSAXKind::Array;
+			type.onElement = [](void* target) {
+				auto& element = static_cast<T*>(target)->emplace_back();
+				return JSONSAXSlot{&element, &jsonSAXType<typename T::value_type>()};
+			};
+		} else {
+			static_assert(isJSONObject<T>::value, "Specialize JSONObject to describe the fields of T.");
+			constexpr auto fieldCount = std::tuple_size_v<std::decay_t<decltype(JSONObject<T>::fields)>>;
+			static_assert(fieldCount <= 64, "JSONObject supports at most 64 fields.");
+			type.kind = JSONSAXKind::Object;
+			type.onKey = [](void* target, std::string_view key, JSONSAXSlot& slot) {
+				return findJSONField<T>(target, key, slot, std::make_index_sequence<fieldCount>{});
+			};
+			type.requiredFields = requiredJSONFields<T>(std::make_index_sequence<fieldCount>{});
+		}
+		return type;
+	}
+
+	// Parses sv into target.target, an object of the C++ type described by target.type.
+	bool parseJSONInto(std::string_view sv, JSONSAXSlot target);
+	// Same as parseJSONInto, decoding strings over buffer, which must hold size characters followed by '\0'.
+	bool parseJSONInsituInto(char* buffer, std::size_t size, JSONSAXSlot target);
+}
+
+template <typename T>
+const JSONSAXType& jsonSAXType()
+{
+	constexpr static JSONSAXType type = detail::makeJSONSAXType<T>();
+	return type;
+}
+
+template <typename T>
+struct JSONSAXValidator
+{
+	using body_checker_type = JSONSyntaxChecker;
+	
+	std::optional<T> operator()(std::string_view sv) const
+	{
+		T value{};
+		if (detail::parseJSONInto(sv, JSONSAXSlot{&value, &jsonSAXType<T>()})) {
+			return value;
+		}
+		return std::nullopt;
+	}
+};
+
+// Parses in place like JSONInsituValidator, std::string_view fields borrow from the request.
+template <typename T>
+struct JSONSAXInsituValidator
+{
+	using body_checker_type = JSONSyntaxChecker;
+	
+	template <typename Context>
+	std::optional<T> operator()(std::string_view sv, Context& ctx) const
+	{
+		T value{};
+		if (detail::parseJSONInsituInto(ctx.insituBuffer(sv), sv.size(), JSONSAXSlot{&value, &jsonSAXType<T>()})) {
+			return value;
+		}
+		return std::nullopt;
+	}
+};
+
+#endif
@@ -1,4 +1,16 @@
 #include "JSONSerializer.hpp"
+#include <stdexcept>
+
+namespace
+{
+	// The writer refuses NaN and infinite numbers, which JSON can't represent.
+	void writeDouble(JSONWriter& writer, double v)
+	{
+		if (!writer.Double(v)) {
+			throw std::domain_error{"JSON can't represent a NaN or an infinite number"};
+		}
+	}
+}
 
 template <>
 rapidjson::Value SerializeJSON<bool>(const bool& v, rapidjson::Document::AllocatorType&)
@@ -21,7 +33,7 @@ rapidjson::Value SerializeJSON<long>(const long& v, rapidjson::Document::Allocat
 template <>
 rapidjson::Value SerializeJSON<long long>(const long long& v, rapidjson::Document::AllocatorType&)
 {
-	return rapidjson::Value(v);
+	return rapidjson::Value(static_cast<int64_t>(v));
 }
 
 template <>
@@ -39,7 +51,7 @@ rapidjson::Value SerializeJSON<unsigned long>(const unsigned long& v, rapidjson:
 template <>
 rapidjson::Value SerializeJSON<unsigned long long>(const unsigned long long& v, rapidjson::Document::AllocatorType&)
 {
-	return rapidjson::Value(v);
+	return rapidjson::Value(static_cast<uint64_t>(v));
 }
 
 template <>
@@ -71,3 +83,75 @@ rapidjson::Value SerializeJSON<std::string_view>(const std::string_view& v, rapi
 {
 	return rapidjson::Value(v.data(), v.size(), allocator);
 }
+
+template <>
+void WriteJSON<bool>(JSONWriter& writer, const bool& v)
+{
+	writer.Bool(v);
+}
+
+template <>
+void WriteJSON<int>(JSONWriter& writer, const int& v)
+{
+	writer.Int(v);
+}
+
+template <>
+void WriteJSON<long>(JSONWriter& writer, const long& v)
+{
+	writer.Int64(static_cast<int64_t>(v));
+}
+
+template <>
+void WriteJSON<long long>(JSONWriter& writer, const long long& v)
+{
+	writer.Int64(static_cast<int64_t>(v));
+}
+
+template <>
+void WriteJSON<unsigned int>(JSONWriter& writer, const unsigned int& v)
+{
+	writer.Uint(v);
+}
+
+template <>
+void WriteJSON<unsigned long>(JSONWriter& writer, const unsigned long& v)
+{
+	writer.Uint64(static_cast<uint64_t>(v));
+}
+
+template <>
+void WriteJSON<unsigned long long>(JSONWriter& writer, const unsigned long long& v)
+{
+	writer.Uint64(static_cast<uint64_t>(v));
+}
+
+template <>
+void WriteJSON<float>(JSONWriter& writer, const float& v)
+{
+	writeDouble(writer, static_cast<double>(v));
+}
+
+template <>
+void WriteJSON<double>(JSONWriter& writer, const double& v)
+{
+	writeDouble(writer, v);
+}
+
+template <>
+void WriteJSON<long double>(JSONWriter& writer, const long double& v)
+{
+	writeDouble(writer, static_cast<double>(v));
+}
+
+template <>
+void WriteJSON<std::string>(JSONWriter& writer, const std::string& v)
+{
+	writer.String(v.data(), static_cast<rapidjson::SizeType>(v.size()));
+}
+
+template <>
+void WriteJSON<std::string_view>(JSONWriter& writer, const std::string_view& v)
+{
+	writer.String(v.data(), static_cast<rapidjson::SizeType>(v.size()));
+}
@@ -1,11 +1,18 @@
 #ifndef JSON_SERIALIZER_HPP
 #define JSON_SERIALIZER_HPP
 
+#include <cstddef>
+#include <cstdint>
+#include "JSONObject.hpp"
+#include "JSONPool.hpp"
 #include <rapidjson/document.h>
-#include <rapidjson/stringbuffer.h>
 #include <rapidjson/writer.h>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <tuple>
 #include <type_traits>
+#include <utility>
 
 template <typename T>
 rapidjson::Value SerializeJSON(const T&, rapidjson::Document::AllocatorType&)
@@ -38,20 +45,153 @@ rapidjson::Value SerializeJSON<std::string>(const std::string&, rapidjson::Docum
 template <>
 rapidjson::Value SerializeJSON<std::string_view>(const std::string_view&, rapidjson::Document::AllocatorType&);
 
+// rapidjson output stream appending to an existing std::string
+struct JSONStringOutputStream
+{
+	using Ch = char;
+	
+	void Put(Ch c)
+	{
+		out.push_back(c);
+	}
+	
+	void Flush()
+	{}
+	
+	std::string& out;
+};
+
+using JSONWriter = rapidjson::Writer<JSONStringOutputStream, rapidjson::UTF8<>, rapidjson::UTF8<>, JSONPoolAllocator>;
+
+/**
+ * WriteJSON emits a value straight into a writer, without building a document first.
+ * Types described by JSONObject, std::vector and std::optional are handled by default,
+ * other user-defined types specialize WriteJSON. Empty std::optional fields are omitted.
+ * A NaN or an infinite number throws std::domain_error rather than emitting invalid JSON.
+ */
+template <typename T>
+void WriteJSON(JSONWriter& writer, const T& v);
+
+template <>
+void WriteJSON<bool>(JSONWriter& writer, const bool& v);
+template <>
+void WriteJSON<int>(JSONWriter& writer, const int& v);
+template <>
+void WriteJSON<long>(JSONWriter& writer, const long& v);
+template <>
+void WriteJSON<long long>(JSONWriter& writer, const long long& v);
+template <>
+void WriteJSON<unsigned int>(JSONWriter& writer, const unsigned int& v);
+template <>
+void WriteJSON<unsigned long>(JSONWriter& writer, const unsigned long& v);
+template <>
+void WriteJSON<unsigned long long>(JSONWriter& writer, const unsigned long long& v);
+template <>
+void WriteJSON<float>(JSONWriter& writer, const float& v);
+template <>
+void WriteJSON<double>(JSONWriter& writer, const double& v);
+template <>
+void WriteJSON<long double>(JSONWriter& writer, const long double& v);
+template <>
+void WriteJSON<std::string>(JSONWriter& writer, const std::string& v);
+template <>
+void WriteJSON<std::string_view>(JSONWriter& writer, const std::string_view& v);
+
+namespace detail
+{
+	template <typename T, std::size_t ... Is>
+	void writeJSONFields(JSONWriter& writer, const T& v, std::index_sequence<Is...>)
+	{
+		([&](const auto& field) {
+			const auto& member = v.*field.member;
+			if constexpr (isStdOptional<std::decay_t<decltype(member)>>::value) {
+				if (!member) {
+					return;
+				}
+			}
+			writer.Key(field.name.data(), static_cast<rapidjson::SizeType>(field.name.size()));
+			WriteJSON(writer, member);
+		}(std::get<Is>(JSONObject<T>::fields)), ...);
+	}
+}
+
+template <typename T>
+void WriteJSON(JSONWriter& writer, const T& v)
+{
+	if constexpr (detail::isStdOptional<T>::value) {
+		if (v) {
+			WriteJSON(writer, *v);
+		} else {
+			writer.Null();
+		}
+	} else if constexpr (detail::isStdVector<T>::value) {
+		writer.StartArray();
+		for (const auto& element : v) {
+			WriteJSON(writer, element);
+		}
+		writer.EndArray();
+	} else {
+		static_assert(detail::isJSONObject<T>::value, "Specialization required.");
+		constexpr auto fieldCount = std::tuple_size_v<std::decay_t<decltype(JSONObject<T>::fields)>>;
+		writer.StartObject();
+		detail::writeJSONFields(writer, v, std::make_index_sequence<fieldCount>{});
+		writer.EndObject();
+	}
+}
+
 template <typename T>
 struct JSONSerializer
 {
 	using value_type = T;
 	
+	constexpr static std::string_view stream_prefix{"["};
+	constexpr static std::string_view stream_separator{","};
+	constexpr static std::string_view stream_suffix{"]"};
+	
 	std::string operator()(const T& t) const
 	{
-		rapidjson::Document doc{rapidjson::kObjectType};
+		std::string result;
+		(*this)(t, result);
+		return result;
+	}
+	
+	void operator()(const T& t, std::string& out) const
+	{
+		JSONPoolLease lease;
+		PooledJSONDocument doc{rapidjson::kObjectType, &lease.allocator(), PooledJSON::stackCapacity, &lease.stackAllocator()};
 		rapidjson::Value& val = doc;
 		val = SerializeJSON<T>(t, doc.GetAllocator());
-		rapidjson::StringBuffer buffer;
-		rapidjson::Writer<rapidjson::StringBuffer> writer{buffer};
-		doc.Accept(writer);
-		return std::string{buffer.GetString(), buffer.GetLength()};
+		JSONStringOutputStream stream{out};
+		rapidjson::Writer<JSONStringOutputStream, rapidjson::UTF8<>, rapidjson::UTF8<>, JSONPoolAllocator> writer{stream, &lease.stackAllocator()};
+		if (!doc.Accept(writer)) {
+			throw std::domain_error{"JSON can't represent a NaN or an infinite number"};
+		}
+	}
+};
+
+// Serializes through WriteJSON : a single pass over the value, no document and no string copies.
+template <typename T>
+struct JSONStreamSerializer
+{
+	using value_type = T;
+	
+	constexpr static std::string_view stream_prefix{"["};
+	constexpr static std::string_view stream_separator{","};
+	constexpr static std::string_view stream_suffix{"]"};
+	
+	std::string operator()(const T& t) const
+	{
+		std::string result;
+		(*this)(t, result);
+		return result;
+	}
+	
+	void operator()(const T& t, std::string& out) const
+	{
+		JSONPoolLease lease;
+		JSONStringOutputStream stream{out};
+		JSONWriter writer{stream, &lease.stackAllocator()};
+		WriteJSON(writer, t);
 	}
 };
 
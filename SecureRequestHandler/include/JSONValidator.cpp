@@ -71,3 +71,12 @@ std::optional<std::string> ValidateJSON<std::string>(const rapidjson::Value& jso
 	}
 	return std::nullopt;
 }
+
+template <>
+std::optional<std::string_view> ValidateJSON<std::string_view>(const rapidjson::Value& json)
+{
+	if (json.IsString()) {
+		return std::string_view{json.GetString(), json.GetStringLength()};
+	}
+	return std::nullopt;
+}
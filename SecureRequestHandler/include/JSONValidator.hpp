@@ -1,11 +1,14 @@
 #ifndef JSON_VALIDATOR_HPP
 #define JSON_VALIDATOR_HPP
 
+#include "BodyChecker.hpp"
+#include "JSONPool.hpp"
 #include <optional>
 #include <rapidjson/document.h>
 #include <string>
 #include <string_view>
 #include <type_traits>
+#include <vector>
 
 template <typename T>
 struct JSONValidator;
@@ -33,6 +36,9 @@ template <>
 std::optional<double> ValidateJSON<double>(const rapidjson::Value& json);
 template <>
 std::optional<std::string> ValidateJSON<std::string>(const rapidjson::Value& json);
+// Borrows from the document, only the context overloads of the validators keep it alive long enough.
+template <>
+std::optional<std::string_view> ValidateJSON<std::string_view>(const rapidjson::Value& json);
 
 template <typename T>
 std::optional<T> ValidateJSON(const rapidjson::Value& json, std::string_view key)
@@ -82,11 +88,94 @@ std::optional<std::vector<T>> ValidateJSONArray(const rapidjson::Value& json, st
 template <typename T>
 struct JSONValidator
 {
+	using body_checker_type = JSONSyntaxChecker;
+	
 	std::optional<T> operator()(std::string_view sv) const
 	{
-		rapidjson::Document doc;
-		if (!doc.Parse(sv.data(), sv.size()).HasParseError()) {
-			return ValidateJSON<T>(doc);
+		PooledJSON json;
+		if (!json.document.Parse(sv.data(), sv.size()).HasParseError()) {
+			return ValidateJSON<T>(json.document);
+		}
+		return std::nullopt;
+	}
+	
+	template <typename Context>
+	std::optional<T> operator()(std::string_view sv, Context& ctx) const
+	{
+		// The document of a request waiting for its body must not hold the thread's pools meanwhile.
+		if (ctx.isPending()) {
+			return validate<DetachedJSON>(sv, ctx);
+		}
+		return validate<PooledJSON>(sv, ctx);
+	}
+	
+private:
+	template <typename JSON, typename Context>
+	static std::optional<T> validate(std::string_view sv, Context& ctx)
+	{
+		const auto& json = ctx.template parseOnce<JSON>(sv, [](JSON& j, std::string_view source) {
+			j.document.Parse(source.data(), source.size());
+		});
+		if (!json.document.HasParseError()) {
+			return ValidateJSON<T>(json.document);
+		}
+		return std::nullopt;
+	}
+};
+
+namespace detail
+{
+	template <typename JSON>
+	struct InsituDocument
+	{
+		JSON json;
+		bool valid = false;
+	};
+	template <>
+	struct InsituDocument<DetachedJSON>
+	{
+		using allocator_type = DetachedJSON::allocator_type;
+		
+		explicit InsituDocument(const allocator_type& allocator) : json{allocator}
+		{}
+		
+		DetachedJSON json;
+		bool valid = false;
+	};
+}
+
+/**
+ * Parses the source in place : strings are decoded into the source's own buffer instead of
+ * being copied into the document, so std::string_view values and fields borrow from the
+ * request. The body of a mutable request is used as is when it is the only input reading
+ * it, other sources are copied once into a buffer owned by the context.
+ */
+template <typename T>
+struct JSONInsituValidator
+{
+	using body_checker_type = JSONSyntaxChecker;
+	
+	template <typename Context>
+	std::optional<T> operator()(std::string_view sv, Context& ctx) const
+	{
+		if (ctx.isPending()) {
+			return validate<DetachedJSON>(sv, ctx);
+		}
+		return validate<PooledJSON>(sv, ctx);
+	}
+	
+private:
+	template <typename JSON, typename Context>
+	static std::optional<T> validate(std::string_view sv, Context& ctx)
+	{
+		const auto& doc = ctx.template parseOnce<detail::InsituDocument<JSON>>(sv, [&ctx](detail::InsituDocument<JSON>& d, std::string_view source) {
+			rapidjson::InsituStringStream stream{ctx.insituBuffer(source)};
+			d.json.document.template ParseStream<rapidjson::kParseInsituFlag>(stream);
+			// A '\0' inside the source ends the parse early, whatever follows must not be ignored.
+			d.valid = !d.json.document.HasParseError() && stream.Tell() == source.size();
+		});
+		if (doc.valid) {
+			return ValidateJSON<T>(doc.json.document);
 		}
 		return std::nullopt;
 	}
@@ -0,0 +1,267 @@
+#include "Metrics.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <limits>
+#include <utility>
+
+namespace
+{
+	std::atomic<std::size_t> nextShard{0};
+
+	void appendEscaped(std::string& out, std::string_view value)
+	{
+		for (char c : value) {
+			switch (c) {
+				case '\\':
+					out += "\\\\";
+					break;
+				case '"':
+					out += "\\\"";
+					break;
+				case '\n':
+					out += "\\n";
+					break;
+				default:
+					out += c;
+			}
+		}
+	}
+
+	void appendNumber(std::string& out, double value)
+	{
+		char buffer[32];
+		const int size = std::snprintf(buffer, sizeof(buffer), "%.12g", value);
+		out.append(buffer, static_cast<std::size_t>(size));
+	}
+
+	void appendFamily(std::string& out, std::string_view name, std::string_view type, std::string_view help)
+	{
+		out.append("# HELP ").append(name).append(" ").append(help).append("\n");
+		out.append("# TYPE ").append(name).append(" ").append(type).append("\n");
+	}
+
+	// labels is a complete label list, e.g. handler="name",outcome="accepted"
+	void appendSample(std::string& out, std::string_view name, std::string_view labels, std::uint64_t value)
+	{
+		out.append(name).append("{").append(labels).append("} ").append(std::to_string(value)).append("\n");
+	}
+
+	void appendHistogram(std::string& out, std::string_view name, std::string_view labels, const MetricsHistogram::Snapshot& histogram)
+	{
+		std::uint64_t cumulated = 0;
+		for (std::size_t i = 0; i < MetricsHistogram::bucketCount; ++i) {
+			cumulated += histogram.buckets[i];
+			out.append(name).append("_bucket{").append(labels).append(",le=\"");
+			if (i + 1 == MetricsHistogram::bucketCount) {
+				out.append("+Inf");
+			} else {
+				appendNumber(out, MetricsHistogram::upperBound(i));
+			}
+			out.append("\"} ").append(std::to_string(cumulated)).append("\n");
+		}
+		out.append(name).append("_sum{").append(labels).append("} ");
+		appendNumber(out, static_cast<double>(histogram.sum) / 1e9);
+		out.append("\n");
+		appendSample(out, std::string{name} + "_count", labels, histogram.count);
+	}
+
+	std::string handlerLabel(const HandlerMetrics& metrics)
+	{
+		std::string label = "handler=\"";
+		appendEscaped(label, metrics.name());
+		label += '"';
+		return label;
+	}
+
+	std::string inputLabels(const HandlerMetrics& metrics, std::size_t input)
+	{
+		std::string labels = handlerLabel(metrics);
+		labels.append(",index=\"").append(std::to_string(input)).append("\",input=\"");
+		appendEscaped(labels, metrics.inputs()[input]);
+		labels += '"';
+		return labels;
+	}
+}
+
+namespace detail
+{
+	std::size_t metricsShard()
+	{
+		thread_local const std::size_t shard = nextShard.fetch_add(1, std::memory_order_relaxed) % metricsShardCount;
+		return shard;
+	}
+}
+
+void MetricsHistogram::addTo(Snapshot& snapshot) const
+{
+	for (std::size_t i = 0; i < bucketCount; ++i) {
+		const auto count = buckets[i].load(std::memory_order_relaxed);
+		snapshot.buckets[i] += count;
+		snapshot.count += count;
+	}
+	snapshot.sum += sum.load(std::memory_order_relaxed);
+}
+
+double MetricsHistogram::upperBound(std::size_t bucket)
+{
+	if (bucket + 1 >= bucketCount) {
+		return std::numeric_limits<double>::infinity();
+	}
+	if (bucket == 0) {
+		return 256e-9;
+	}
+	const auto highestBit = 8 + (bucket - 1) / 2;
+	const auto half = (bucket - 1) % 2;
+	const double base = static_cast<double>(std::uint64_t{1} << highestBit);
+	return (half ? 2 * base : 1.5 * base) / 1e9;
+}
+
+HandlerMetrics::HandlerMetrics(std::string name, std::vector<std::string> inputs)
+: handlerName{std::move(name)}
+, inputNames{std::move(inputs)}
+, shards{new Shard[detail::metricsShardCount]}
+, inputShards{new InputShard[detail::metricsShardCount * inputNames.size()]}
+{}
+
+HandlerMetrics::Snapshot HandlerMetrics::snapshot() const
+{
+	Snapshot snapshot;
+	snapshot.inputRejections.resize(inputNames.size());
+	snapshot.validation.resize(inputNames.size());
+	for (std::size_t s = 0; s < detail::metricsShardCount; ++s) {
+		const auto& shard = shards[s];
+		snapshot.accepted += shard.accepted.load(std::memory_order_relaxed);
+		snapshot.rejected += shard.rejected.load(std::memory_order_relaxed);
+		shard.handler.addTo(snapshot.handler);
+		shard.serialization.addTo(snapshot.serialization);
+		for (std::size_t i = 0; i < inputNames.size(); ++i) {
+			const auto& inputShard = inputShards[s * inputNames.size() + i];
+			snapshot.inputRejections[i] += inputShard.rejected.load(std::memory_order_relaxed);
+			inputShard.validation.addTo(snapshot.validation[i]);
+		}
+	}
+	return snapshot;
+}
+
+CacheMetrics::Snapshot CacheMetrics::snapshot() const
+{
+	Snapshot snapshot;
+	for (const auto& shard : shards) {
+		snapshot.hits += shard.hits.load(std::memory_order_relaxed);
+		snapshot.misses += shard.misses.load(std::memory_order_relaxed);
+		snapshot.evictions += shard.evictions.load(std::memory_order_relaxed);
+		snapshot.expirations += shard.expirations.load(std::memory_order_relaxed);
+		snapshot.entries += shard.entries.load(std::memory_order_relaxed);
+		snapshot.bytes += shard.bytes.load(std::memory_order_relaxed);
+	}
+	return snapshot;
+}
+
+MetricsRegistry& MetricsRegistry::global()
+{
+	static MetricsRegistry registry;
+	return registry;
+}
+
+HandlerMetrics& MetricsRegistry::handler(std::string_view name, std::vector<std::string> inputs)
+{
+	std::lock_guard<std::mutex> lock{mutex};
+	for (const auto& metrics : handlers) {
+		if (metrics->name() == name && metrics->inputs() == inputs) {
+			return *metrics;
+		}
+	}
+	handlers.push_back(std::make_unique<HandlerMetrics>(std::string{name}, std::move(inputs)));
+	return *handlers.back();
+}
+
+void MetricsRegistry::addCache(std::string_view name, std::shared_ptr<const CacheMetrics> metrics)
+{
+	std::lock_guard<std::mutex> lock{mutex};
+	for (auto& cache : caches) {
+		if (cache.first == name) {
+			cache.second = std::move(metrics);
+			return;
+		}
+	}
+	caches.emplace_back(std::string{name}, std::move(metrics));
+}
+
+void MetricsRegistry::render(std::string& out) const
+{
+	std::vector<std::pair<const HandlerMetrics*, HandlerMetrics::Snapshot>> snapshots;
+	std::vector<std::pair<std::string, CacheMetrics::Snapshot>> cacheSnapshots;
+	{
+		std::lock_guard<std::mutex> lock{mutex};
+		snapshots.reserve(handlers.size());
+		for (const auto& metrics : handlers) {
+			snapshots.emplace_back(metrics.get(), metrics->snapshot());
+		}
+		cacheSnapshots.reserve(caches.size());
+		for (const auto& [name, metrics] : caches) {
+			std::string label = "handler=\"";
+			appendEscaped(label, name);
+			label += '"';
+			cacheSnapshots.emplace_back(std::move(label), metrics->snapshot());
+		}
+	}
+
+	// Prometheus expects the samples of a metric to be grouped under its type.
+	appendFamily(out, "srh_requests_total", "counter", "Requests handled, by whether their inputs were accepted.");
+	for (const auto& [metrics, snapshot] : snapshots) {
+		const auto labels = handlerLabel(*metrics);
+		appendSample(out, "srh_requests_total", labels + ",outcome=\"accepted\"", snapshot.accepted);
+		appendSample(out, "srh_requests_total", labels + ",outcome=\"rejected\"", snapshot.rejected);
+	}
+	appendFamily(out, "srh_input_rejections_total", "counter", "Requests rejected by each input, the first invalid input of a request rejects it.");
+	for (const auto& [metrics, snapshot] : snapshots) {
+		for (std::size_t i = 0; i < snapshot.inputRejections.size(); ++i) {
+			appendSample(out, "srh_input_rejections_total", inputLabels(*metrics, i), snapshot.inputRejections[i]);
+		}
+	}
+	appendFamily(out, "srh_validation_seconds", "histogram", "Time spent reading and validating each input.");
+	for (const auto& [metrics, snapshot] : snapshots) {
+		for (std::size_t i = 0; i < snapshot.validation.size(); ++i) {
+			appendHistogram(out, "srh_validation_seconds", inputLabels(*metrics, i), snapshot.validation[i]);
+		}
+	}
+	appendFamily(out, "srh_handler_seconds", "histogram", "Time spent in the handler of accepted requests, serialization excluded.");
+	for (const auto& [metrics, snapshot] : snapshots) {
+		appendHistogram(out, "srh_handler_seconds", handlerLabel(*metrics), snapshot.handler);
+	}
+	appendFamily(out, "srh_serialization_seconds", "histogram", "Time spent serializing the responses of accepted requests.");
+	for (const auto& [metrics, snapshot] : snapshots) {
+		appendHistogram(out, "srh_serialization_seconds", handlerLabel(*metrics), snapshot.serialization);
+	}
+	if (cacheSnapshots.empty()) {
+		return;
+	}
+	appendFamily(out, "srh_cache_hits_total", "counter", "Responses served from the cache.");
+	for (const auto& [labels, snapshot] : cacheSnapshots) {
+		appendSample(out, "srh_cache_hits_total", labels, snapshot.hits);
+	}
+	appendFamily(out, "srh_cache_misses_total", "counter", "Requests the cache had no response for.");
+	for (const auto& [labels, snapshot] : cacheSnapshots) {
+		appendSample(out, "srh_cache_misses_total", labels, snapshot.misses);
+	}
+	appendFamily(out, "srh_cache_evictions_total", "counter", "Responses removed from the cache, because it was full or because they expired.");
+	for (const auto& [labels, snapshot] : cacheSnapshots) {
+		appendSample(out, "srh_cache_evictions_total", labels + ",reason=\"capacity\"", snapshot.evictions);
+		appendSample(out, "srh_cache_evictions_total", labels + ",reason=\"expired\"", snapshot.expirations);
+	}
+	appendFamily(out, "srh_cache_entries", "gauge", "Responses in the cache.");
+	for (const auto& [labels, snapshot] : cacheSnapshots) {
+		appendSample(out, "srh_cache_entries", labels, static_cast<std::uint64_t>(std::max<std::int64_t>(snapshot.entries, 0)));
+	}
+	appendFamily(out, "srh_cache_bytes", "gauge", "Size of the keys and responses in the cache.");
+	for (const auto& [labels, snapshot] : cacheSnapshots) {
+		appendSample(out, "srh_cache_bytes", labels, static_cast<std::uint64_t>(std::max<std::int64_t>(snapshot.bytes, 0)));
+	}
+}
+
+std::string renderPrometheusMetrics(const MetricsRegistry& registry)
+{
+	std::string out;
+	registry.render(out);
+	return out;
+}
@@ -0,0 +1,368 @@
+#ifndef METRICS_HPP
+#define METRICS_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ * Request metrics, rendered in the Prometheus text format.
+ *
+ * A handler observed by MetricsObserver whose metrics are enabled counts the requests it
+ * accepts and rejects, which of its inputs rejected them, and records how long validating
+ * each input, running the handler and serializing the response took. Counters and histograms are split in shards, and each
+ * thread updates its own shard with relaxed atomic increments : recording never takes a
+ * lock, and threads don't write to the same cache lines. The shards are only summed when
+ * the metrics are rendered.
+ *
+ * Usage example :
+ *
+
+ auto addCustomer = makeBeastRequestHandler<Output, Inputs...>(handler, MetricsObserver{});
+ addCustomer.enableMetrics("add-customer");
+ // or, naming every route "VERB /path"
+ router.enableMetrics();
+ // and serving them, e.g. as Route<typestring_is("GET"), typestring_is("/metrics"), decltype(metrics)>
+ auto metrics = makeBeastMetricsHandler();
+
+ *
+ */
+
+using MetricsClock = std::chrono::steady_clock;
+
+namespace detail
+{
+	// Threads are spread over the shards in the order they first record a metric.
+	constexpr std::size_t metricsShardCount = 16;
+	std::size_t metricsShard();
+
+	// Where the serializer of the observed handler running on this thread adds its time, if any.
+	inline thread_local MetricsClock::duration* serializationTime = nullptr;
+
+	class SerializationScope
+	{
+	public:
+		explicit SerializationScope(MetricsClock::duration& total) : previous{serializationTime}
+		{
+			serializationTime = &total;
+		}
+
+		~SerializationScope()
+		{
+			serializationTime = previous;
+		}
+
+		SerializationScope(const SerializationScope&) = delete;
+		SerializationScope& operator=(const SerializationScope&) = delete;
+
+	private:
+		MetricsClock::duration* previous;
+	};
+}
+
+// Request adapters serialize responses through this, so that the serialization is told apart from the handler.
+template <typename Function>
+void timeSerialization(Function&& serialize)
+{
+	if (auto* total = detail::serializationTime) {
+		const auto start = MetricsClock::now();
+		serialize();
+		*total += MetricsClock::now() - start;
+	} else {
+		serialize();
+	}
+}
+
+/**
+ * Log-linear latency histogram : each power of two nanoseconds is split in two buckets,
+ * from 256 ns up to 2^35 ns (about 34 s), past which durations fall in an overflow bucket.
+ */
+class MetricsHistogram
+{
+public:
+	constexpr static std::size_t bucketCount = 56;
+
+	struct Snapshot
+	{
+		std::array<std::uint64_t, bucketCount> buckets{};
+		std::uint64_t count = 0;
+		std::uint64_t sum = 0;
+	};
+
+	void record(MetricsClock::duration duration)
+	{
+		const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+		const auto value = static_cast<std::uint64_t>(ns > 0 ? ns : 0);
+		buckets[indexOf(value)].fetch_add(1, std::memory_order_relaxed);
+		sum.fetch_add(value, std::memory_order_relaxed);
+	}
+
+	void addTo(Snapshot& snapshot) const;
+
+	// Upper bound of a bucket, in seconds, infinite for the overflow bucket.
+	static double upperBound(std::size_t bucket);
+
+private:
+	static std::size_t indexOf(std::uint64_t ns)
+	{
+		if (ns < 256) {
+			return 0;
+		}
+		const unsigned int highestBit = 63 - static_cast<unsigned int>(__builtin_clzll(ns));
+		const std::size_t index = 1 + (highestBit - 8) * 2 + ((ns >> (highestBit - 1)) & 1);
+		return index < bucketCount ? index : bucketCount - 1;
+	}
+
+	std::array<std::atomic<std::uint64_t>, bucketCount> buckets{};
+	std::atomic<std::uint64_t> sum{0};
+};
+
+class HandlerMetrics
+{
+public:
+	struct Snapshot
+	{
+		std::uint64_t accepted = 0;
+		std::uint64_t rejected = 0;
+		std::vector<std::uint64_t> inputRejections;
+		std::vector<MetricsHistogram::Snapshot> validation;
+		MetricsHistogram::Snapshot handler;
+		MetricsHistogram::Snapshot serialization;
+	};
+
+	HandlerMetrics(std::string name, std::vector<std::string> inputs);
+
+	const std::string& name() const
+	{
+		return handlerName;
+	}
+
+	// Describes each input, e.g. "body" or "header:host".
+	const std::vector<std::string>& inputs() const
+	{
+		return inputNames;
+	}
+
+	void recordInput(std::size_t input, MetricsClock::duration duration, bool accepted)
+	{
+		auto& shard = inputShards[detail::metricsShard() * inputNames.size() + input];
+		shard.validation.record(duration);
+		if (!accepted) {
+			shard.rejected.fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+
+	// The handler's duration excludes the serialization's.
+	void recordAccepted(MetricsClock::duration handler, MetricsClock::duration serialization)
+	{
+		auto& shard = shards[detail::metricsShard()];
+		shard.accepted.fetch_add(1, std::memory_order_relaxed);
+		shard.handler.record(handler);
+		shard.serialization.record(serialization);
+	}
+
+	void recordRejected()
+	{
+		shards[detail::metricsShard()].rejected.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	Snapshot snapshot() const;
+
+private:
+	struct alignas(64) Shard
+	{
+		std::atomic<std::uint64_t> accepted{0};
+		std::atomic<std::uint64_t> rejected{0};
+		MetricsHistogram handler;
+		MetricsHistogram serialization;
+	};
+
+	struct alignas(64) InputShard
+	{
+		std::atomic<std::uint64_t> rejected{0};
+		MetricsHistogram validation;
+	};
+
+	std::string handlerName;
+	std::vector<std::string> inputNames;
+	std::unique_ptr<Shard[]> shards;
+	// metricsShardCount rows of one InputShard per input.
+	std::unique_ptr<InputShard[]> inputShards;
+};
+
+/**
+ * Observer policy recording a handler's requests into its metrics, see NoObserver in
+ * SecureRequestHandler.hpp. It records nothing until the handler's metrics are enabled,
+ * and times each request with its own Recorder.
+ */
+class MetricsObserver
+{
+public:
+	class Recorder
+	{
+	public:
+		explicit Recorder(const MetricsObserver& observer) : metrics{observer.metrics} {}
+
+		template <typename RequestType>
+		void on_request_start(const RequestType&)
+		{
+			if (metrics) {
+				last = MetricsClock::now();
+			}
+		}
+
+		template <std::size_t I, typename RequestType>
+		void on_input_validated(const RequestType&, bool valid)
+		{
+			if (!metrics) {
+				return;
+			}
+			const auto now = MetricsClock::now();
+			metrics->recordInput(I, now - last, valid);
+			if (!valid) {
+				metrics->recordRejected();
+			}
+			last = now;
+		}
+
+		// The body inputs are timed from the reception of the body, not from the last header input.
+		template <typename RequestType>
+		void on_body_received(const RequestType&)
+		{
+			if (metrics) {
+				last = MetricsClock::now();
+			}
+		}
+
+		template <typename RequestType>
+		void on_handler_done(const RequestType&)
+		{
+			if (metrics) {
+				handlerDone = MetricsClock::now();
+			}
+		}
+
+		template <typename RequestType>
+		void on_serialized(const RequestType&, MetricsClock::duration serialization)
+		{
+			if (metrics) {
+				metrics->recordAccepted(handlerDone - last - serialization, serialization);
+			}
+		}
+
+	private:
+		HandlerMetrics* metrics;
+		MetricsClock::time_point last;
+		MetricsClock::time_point handlerDone;
+	};
+
+	using request_observer_type = Recorder;
+
+	void enable(HandlerMetrics& handlerMetrics)
+	{
+		metrics = &handlerMetrics;
+	}
+
+private:
+	HandlerMetrics* metrics = nullptr;
+};
+
+// Counters of a ResponseCache, see ResponseCache.hpp. Sharded like HandlerMetrics.
+class CacheMetrics
+{
+public:
+	struct Snapshot
+	{
+		std::uint64_t hits = 0;
+		std::uint64_t misses = 0;
+		std::uint64_t evictions = 0;
+		std::uint64_t expirations = 0;
+		std::int64_t entries = 0;
+		std::int64_t bytes = 0;
+	};
+
+	void recordHit()
+	{
+		shards[detail::metricsShard()].hits.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	void recordMiss()
+	{
+		shards[detail::metricsShard()].misses.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	void recordInsertion(std::size_t bytes)
+	{
+		auto& shard = shards[detail::metricsShard()];
+		shard.entries.fetch_add(1, std::memory_order_relaxed);
+		shard.bytes.fetch_add(static_cast<std::int64_t>(bytes), std::memory_order_relaxed);
+	}
+
+	// Removed because the cache was full, or because the entry expired.
+	void recordRemoval(std::size_t bytes, bool expired)
+	{
+		auto& shard = shards[detail::metricsShard()];
+		shard.entries.fetch_sub(1, std::memory_order_relaxed);
+		shard.bytes.fetch_sub(static_cast<std::int64_t>(bytes), std::memory_order_relaxed);
+		(expired ? shard.expirations : shard.evictions).fetch_add(1, std::memory_order_relaxed);
+	}
+
+	Snapshot snapshot() const;
+
+private:
+	// Entries and bytes are inserted and removed from any shard, only their sum is meaningful.
+	struct alignas(64) Shard
+	{
+		std::atomic<std::uint64_t> hits{0};
+		std::atomic<std::uint64_t> misses{0};
+		std::atomic<std::uint64_t> evictions{0};
+		std::atomic<std::uint64_t> expirations{0};
+		std::atomic<std::int64_t> entries{0};
+		std::atomic<std::int64_t> bytes{0};
+	};
+
+	std::array<Shard, detail::metricsShardCount> shards;
+};
+
+class MetricsRegistry
+{
+public:
+	// Used by handlers enabling their metrics without naming a registry.
+	static MetricsRegistry& global();
+
+	// The metrics of the handler named name, created on first use. The metrics live as long as the registry.
+	// Handlers registered with the same name and inputs share their metrics.
+	HandlerMetrics& handler(std::string_view name, std::vector<std::string> inputs);
+
+	// Renders the counters of a cache under name, for as long as the registry lives.
+	void addCache(std::string_view name, std::shared_ptr<const CacheMetrics> metrics);
+
+	// Appends every metric to out, in the Prometheus text exposition format.
+	void render(std::string& out) const;
+
+private:
+	mutable std::mutex mutex;
+	std::vector<std::unique_ptr<HandlerMetrics>> handlers;
+	std::vector<std::pair<std::string, std::shared_ptr<const CacheMetrics>>> caches;
+};
+
+std::string renderPrometheusMetrics(const MetricsRegistry& registry = MetricsRegistry::global());
+
+namespace detail
+{
+	template <typename Handler, typename = void>
+	struct hasMetrics : std::false_type {};
+	template <typename Handler>
+	struct hasMetrics<Handler, std::void_t<decltype(std::declval<Handler&>().enableMetrics(std::string_view{}, std::declval<MetricsRegistry&>()))>> : std::true_type {};
+}
+
+#endif
@@ -1,12 +1,44 @@
 #ifndef QUERY_STRING_HPP
 #define QUERY_STRING_HPP
 
+#include <forward_list>
+#include <memory_resource>
 #include <string>
 #include <string_view>
 #include <utility>
 #include <vector>
 
-using QueryString = std::vector<std::pair<std::string_view, std::string_view>>;
+// Parsed with the resource of the request it is read from, see RequestContext.
+// The escaped values decoded out of it are kept as long as it lives, so that
+// validated values may borrow them the way they borrow the plain ones.
+class QueryString : public std::pmr::vector<std::pair<std::string_view, std::string_view>>
+{
+public:
+	QueryString() = default;
+	
+	explicit QueryString(const allocator_type& allocator)
+	: vector(allocator)
+	, decoded(allocator)
+	{}
+	
+	// A query string nested in one of the values of enclosing keeps its decoded values there.
+	void keepDecodedIn(const QueryString& enclosing)
+	{
+		this->enclosing = &enclosing;
+	}
+	
+	std::pmr::string& decodingBuffer() const
+	{
+		if (enclosing) {
+			return enclosing->decodingBuffer();
+		}
+		return decoded.emplace_front();
+	}
+	
+private:
+	mutable std::pmr::forward_list<std::pmr::string> decoded;
+	const QueryString* enclosing = nullptr;
+};
 using QueryStringBuffer = std::vector<std::pair<std::string, std::string>>;
 
 #endif
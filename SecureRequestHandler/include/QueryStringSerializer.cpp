@@ -1,51 +1,68 @@
 #include "QueryStringSerializer.hpp"
 
+#include <algorithm>
 #include <numeric>
 
-std::string encodeURIComponent(std::string_view sv)
+void appendURIComponent(std::string& out, std::string_view sv)
 {
-	std::string result;
 	for (unsigned char c : sv) {
 		if	(
 					(c >= '0' && c <= '9')
 					|| (c >= 'a' && c <= 'z')
 					|| (c >= 'A' && c <= 'Z')
 				 ) {
-			result += c;
+			out += c;
 		} else {
 			unsigned char upper = c >> 4;
 			unsigned char lower = c & 0xF;
-			result += '%';
-			result += ((upper >= 10) ? ('a' - 10) : '0') + upper;
-			result += ((lower >= 10) ? ('a' - 10) : '0') + lower;
+			out += '%';
+			out += ((upper >= 10) ? ('a' - 10) : '0') + upper;
+			out += ((lower >= 10) ? ('a' - 10) : '0') + lower;
 		}
 	}
+}
+
+std::string encodeURIComponent(std::string_view sv)
+{
+	std::string result;
+	appendURIComponent(result, sv);
 	return result;
 }
 
 std::size_t estimateEncodedStringLength(const QueryStringBuffer& qs)
 {
-	auto rawLength = std::accumulate(qs.begin(), qs.end(), 0, [](int total, const std::pair<std::string_view, std::string_view>& element) -> int {
-		return element.first.length() + (element.second.empty() ? 0 : element.second.length() + 1);
+	if (qs.empty()) {
+		return 0;
+	}
+	auto rawLength = std::accumulate(qs.begin(), qs.end(), std::size_t{0}, [](std::size_t total, const QueryStringBuffer::value_type& element) -> std::size_t {
+		return total + element.first.length() + (element.second.empty() ? 0 : element.second.length() + 1);
 	});
 	rawLength += qs.size() - 1;
 	return rawLength * 2;
 }
 
-std::string makeIntoString(const QueryStringBuffer& qs)
+void appendQueryString(std::string& out, const QueryStringBuffer& qs)
 {
-	std::string result;
-	result.reserve(estimateEncodedStringLength(qs));
+	const auto required = out.size() + estimateEncodedStringLength(qs);
+	if (out.capacity() < required) {
+		out.reserve(std::max(required, out.capacity() * 2));
+	}
 	for (const auto& element : qs) {
-		result += encodeURIComponent(element.first);
+		appendURIComponent(out, element.first);
 		if (!element.second.empty()) {
-			result += '=';
-			result += encodeURIComponent(element.second);
+			out += '=';
+			appendURIComponent(out, element.second);
 		}
-		result += '&';
+		out += '&';
 	}
 	if (!qs.empty()) {
-		result.pop_back();
+		out.pop_back();
 	}
+}
+
+std::string makeIntoString(const QueryStringBuffer& qs)
+{
+	std::string result;
+	appendQueryString(result, qs);
 	return result;
 }
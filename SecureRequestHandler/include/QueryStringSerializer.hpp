@@ -7,6 +7,7 @@
 #include <string_view>
 
 std::string encodeURIComponent(std::string_view sv);
+void appendURIComponent(std::string& out, std::string_view sv);
 
 template <typename T>
 QueryStringBuffer SerializeQueryString(const T&)
@@ -15,6 +16,7 @@ QueryStringBuffer SerializeQueryString(const T&)
 }
 
 std::string makeIntoString(const QueryStringBuffer&);
+void appendQueryString(std::string& out, const QueryStringBuffer&);
 
 template <typename T>
 struct QueryStringSerializer
@@ -25,6 +27,11 @@ struct QueryStringSerializer
 	{
 		return makeIntoString(SerializeQueryString<T>(t));
 	}
+	
+	void operator()(const T& t, std::string& out) const
+	{
+		appendQueryString(out, SerializeQueryString<T>(t));
+	}
 };
 
 #endif
@@ -14,35 +14,46 @@
  * limitations under the License.
  *
  * This file has a member function implementation coming from the Folly library
- * which was adaptated into the Validator concept.
+ * which was adaptated into the Validator concept. The query string regex has since
+ * been replaced by an equivalent single-pass tokenizer.
  */
 
 #include "QueryStringValidator.hpp"
-#include <boost/regex.hpp>
+#include "CharScan.hpp"
 
-std::vector<std::pair<std::string_view, std::string_view>>
-QueryStringValidatorBase::getQueryParams(std::string_view str) const
+QueryString QueryStringValidatorBase::getQueryParams(std::string_view str, std::pmr::memory_resource* resource) const
 {
-	std::vector<std::pair<std::string_view, std::string_view>> result;
+	// Single pass over the '&' and '=' delimiters, equivalent to matching
+	// "(^|&)([^=&]*)=?([^=&]*)(?=(&|$))" repeatedly: parameters with an empty
+	// name or with more than one '=' are ignored.
+	QueryString result{resource};
 	if (!str.empty()) {
-		// Parse query string
-		static const boost::regex queryParamRegex(
-																							"(^|&)" /*start of query or start of parameter "&"*/
-																							"([^=&]*)=?" /*parameter name and "=" if value is expected*/
-																							"([^=&]*)" /*parameter value*/
-																							"(?=(&|$))" /*forward reference, next should be end of query or
-																													 start of next parameter*/);
-		const boost::cregex_iterator paramBeginItr(str.data(), str.data() + str.size(), queryParamRegex);
-		boost::cregex_iterator paramEndItr;
-		for (auto itr = paramBeginItr; itr != paramEndItr; ++itr) {
-			if (itr->length(2) == 0) {
-				// key is empty, ignore it
-				continue;
+		constexpr auto npos = std::string_view::npos;
+		std::size_t paramBegin = 0;
+		std::size_t equalSign = npos;
+		bool ambiguous = false;
+		const auto addParam = [&](std::size_t paramEnd) {
+			const auto nameEnd = (equalSign == npos) ? paramEnd : equalSign;
+			if (!ambiguous && nameEnd != paramBegin) {
+				const auto valueBegin = (equalSign == npos) ? paramEnd : equalSign + 1;
+				result.emplace_back(
+														str.substr(paramBegin, nameEnd - paramBegin),
+														str.substr(valueBegin, paramEnd - valueBegin));
 			}
-			result.emplace_back(
-													std::string_view{(*itr)[2].first, static_cast<std::string_view::size_type>(std::distance((*itr)[2].first, (*itr)[2].second))},
-													std::string_view{(*itr)[3].first, static_cast<std::string_view::size_type>(std::distance((*itr)[3].first, (*itr)[3].second))});
-		}
+		};
+		detail::forEachOf(str, '&', '=', [&](std::size_t position) {
+			if (str[position] == '&') {
+				addParam(position);
+				paramBegin = position + 1;
+				equalSign = npos;
+				ambiguous = false;
+			} else if (equalSign == npos) {
+				equalSign = position;
+			} else {
+				ambiguous = true;
+			}
+		});
+		addParam(str.size());
 	}
 	return result;
 }
@@ -59,32 +70,76 @@ static std::optional<unsigned int> parseHexDigit(unsigned char c)
 	return std::nullopt;
 }
 
-std::optional<std::string> decodeURIComponent(std::string_view str)
+template <typename Buffer>
+static std::optional<std::string_view> decodeInto(std::string_view str, std::size_t escape, Buffer& buffer)
 {
-	std::string result;
-	const std::string::size_type maxPositionLastPercent = str.length() - 2;
-	
-	for (std::string::size_type i = 0, n = str.length(); i < n; i++) {
-		char c = str[i];
-		if (c != '%'){
-			if (c == '+')
-				result += ' ';
-			else
-				result += c;
-		} else {
-			if (i < maxPositionLastPercent) {
-				const auto d1Opt = parseHexDigit(str[i+1]);
-				const auto d2Opt = parseHexDigit(str[i+2]);
-				if (d1Opt && d2Opt) {
-					result += static_cast<char>(*d1Opt * 16 + *d2Opt);
-					i += 2;
-				} else {
-					return std::nullopt;
-				}
+	constexpr auto npos = std::string_view::npos;
+	buffer.clear();
+	buffer.reserve(str.length());
+	typename Buffer::size_type i = 0;
+	const auto n = str.length();
+	while (escape != npos) {
+		buffer.append(str.data() + i, escape - i);
+		i = escape;
+		if (str[i] == '+') {
+			buffer += ' ';
+			i += 1;
+		} else if (n - i > 2) {
+			const auto d1Opt = parseHexDigit(str[i+1]);
+			const auto d2Opt = parseHexDigit(str[i+2]);
+			if (d1Opt && d2Opt) {
+				buffer += static_cast<char>(*d1Opt * 16 + *d2Opt);
+				i += 3;
 			} else {
 				return std::nullopt;
 			}
+		} else {
+			return std::nullopt;
+		}
+		escape = detail::findFirstOf(str.substr(i), '%', '+');
+		if (escape != npos) {
+			escape += i;
 		}
 	}
-	return result;
+	buffer.append(str.data() + i, n - i);
+	return std::string_view{buffer};
+}
+
+template <typename GetBuffer>
+static std::optional<std::string_view> decodeWith(std::string_view str, GetBuffer getBuffer)
+{
+	const auto escape = detail::findFirstOf(str, '%', '+');
+	if (escape == std::string_view::npos) {
+		return str;
+	}
+	return decodeInto(str, escape, getBuffer());
+}
+
+std::optional<std::string_view> decodeURIComponent(std::string_view str, std::string& buffer)
+{
+	return decodeWith(str, [&buffer]() -> std::string& { return buffer; });
+}
+
+std::optional<std::string_view> decodeURIComponent(std::string_view str, std::pmr::string& buffer)
+{
+	return decodeWith(str, [&buffer]() -> std::pmr::string& { return buffer; });
+}
+
+std::optional<std::string_view> decodeURIComponent(std::string_view str, const QueryString& queryString)
+{
+	// Only escaped values take a buffer from the query string.
+	return decodeWith(str, [&queryString]() -> std::pmr::string& { return queryString.decodingBuffer(); });
+}
+
+std::optional<std::string> decodeURIComponent(std::string_view str)
+{
+	std::string buffer;
+	const auto decoded = decodeURIComponent(str, buffer);
+	if (decoded) {
+		if (decoded->data() == buffer.data()) {
+			return buffer;
+		}
+		return std::string{*decoded};
+	}
+	return std::nullopt;
 }
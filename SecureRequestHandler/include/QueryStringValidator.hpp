@@ -4,6 +4,7 @@
 #include <algorithm>
 #include <cctype>
 #include <cstdio>
+#include <memory_resource>
 #include <optional>
 #include <string>
 #include <string_view>
@@ -12,6 +13,12 @@
 #include "QueryString.hpp"
 #include <vector>
 
+// Returns str itself when it holds no escape sequence, otherwise decodes it into buffer
+// and returns a view over buffer. Only escaped values ever touch the buffer.
+std::optional<std::string_view> decodeURIComponent(std::string_view str, std::string& buffer);
+std::optional<std::string_view> decodeURIComponent(std::string_view str, std::pmr::string& buffer);
+// Same, decoding into a buffer kept by queryString.
+std::optional<std::string_view> decodeURIComponent(std::string_view str, const QueryString& queryString);
 std::optional<std::string> decodeURIComponent(std::string_view str);
 
 template <typename T>
@@ -31,9 +38,14 @@ std::optional<T> ValidateQueryString(const QueryString& queryString, std::string
 	if (itParam == itEnd) {
 		return std::nullopt;
 	} else {
-		auto valeurDecodee = decodeURIComponent(itParam->second);
+		// Decoded values and nested query strings live as long as the query string itself.
+		auto valeurDecodee = decodeURIComponent(itParam->second, queryString);
 		if (valeurDecodee) {
-			return validator(std::string_view{*valeurDecodee});
+			if constexpr (std::is_invocable_v<Validator&, std::string_view, const QueryString&>) {
+				return validator(*valeurDecodee, queryString);
+			} else {
+				return validator(*valeurDecodee);
+			}
 		} else {
 			return std::nullopt;
 		}
@@ -42,16 +54,34 @@ std::optional<T> ValidateQueryString(const QueryString& queryString, std::string
 
 struct QueryStringValidatorBase
 {
-	QueryString getQueryParams(std::string_view) const;
+	QueryString getQueryParams(std::string_view, std::pmr::memory_resource* resource = std::pmr::get_default_resource()) const;
 };
 
 template <typename T>
 struct QueryStringValidator : private QueryStringValidatorBase
 {
+	// Values which borrow decoded text must be validated through a RequestContext,
+	// the query string parsed here is gone once the value is returned.
 	std::optional<T> operator()(std::string_view sv) const
 	{
 		return ValidateQueryString<T>(getQueryParams(sv));
 	}
+	
+	std::optional<T> operator()(std::string_view sv, const QueryString& enclosing) const
+	{
+		auto queryString = getQueryParams(sv, enclosing.get_allocator().resource());
+		queryString.keepDecodedIn(enclosing);
+		return ValidateQueryString<T>(queryString);
+	}
+	
+	template <typename Context>
+	std::optional<T> operator()(std::string_view sv, Context& ctx) const
+	{
+		const auto& queryString = ctx.template parseOnce<QueryString>(sv, [this, &ctx](QueryString& qs, std::string_view source) {
+			qs = getQueryParams(source, ctx.resource());
+		});
+		return ValidateQueryString<T>(queryString);
+	}
 };
 
 #endif
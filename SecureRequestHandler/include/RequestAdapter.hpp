@@ -3,6 +3,7 @@
 
 #include <string_view>
 #include <type_traits>
+#include <utility>
 
 template <typename RequestType>
 struct RequestAdapter
@@ -15,6 +16,8 @@ struct RequestAdapter
 	using make_response_type = void;
 	
 	constexpr static status_type BadRequest = 400u;
+	constexpr static status_type MethodNotAllowed = 405u;
+	constexpr static status_type NotFound = 404u;
 	constexpr static status_type Ok = 200u;
 	
 	static std::string_view getHeader(const request_type&, std::string_view)
@@ -27,6 +30,12 @@ struct RequestAdapter
 		static_assert(!std::is_same_v<RequestType, RequestType>, "Specialize RequestAdapter for your http library.");
 	}
 	
+	// Null-terminated and writable body, or nullptr when the library can't provide one.
+	static char* getMutableBody(request_type&)
+	{
+		static_assert(!std::is_same_v<RequestType, RequestType>, "Specialize RequestAdapter for your http library.");
+	}
+	
 	static std::string_view getPath(const request_type&)
 	{
 		static_assert(!std::is_same_v<RequestType, RequestType>, "Specialize RequestAdapter for your http library.");
@@ -37,6 +46,11 @@ struct RequestAdapter
 		static_assert(!std::is_same_v<RequestType, RequestType>, "Specialize RequestAdapter for your http library.");
 	}
 	
+	static std::pair<std::string_view, std::string_view> splitTarget(const request_type&)
+	{
+		static_assert(!std::is_same_v<RequestType, RequestType>, "Specialize RequestAdapter for your http library.");
+	}
+	
 	static std::string_view getVerb(const request_type&)
 	{
 		static_assert(!std::is_same_v<RequestType, RequestType>, "Specialize RequestAdapter for your http library.");
@@ -0,0 +1,87 @@
+#include <array>
+#include "BlockSizing.hpp"
+#include "RequestArena.hpp"
+#include <memory>
+
+namespace
+{
+	detail::BlockSizing sizing{64 * 1024};
+}
+
+namespace detail
+{
+	struct RequestArenaBlock
+	{
+		std::unique_ptr<std::byte[]> data;
+		std::size_t size = BlockSizing::initialBlockSize;
+		bool inUse = false;
+	};
+
+	void* CountingResource::do_allocate(std::size_t bytes, std::size_t alignment)
+	{
+		total += bytes;
+		return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+	}
+
+	void CountingResource::do_deallocate(void* p, std::size_t bytes, std::size_t alignment)
+	{
+		std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+	}
+
+	bool CountingResource::do_is_equal(const std::pmr::memory_resource& other) const noexcept
+	{
+		return this == &other;
+	}
+}
+
+namespace
+{
+	// Requests of a thread in progress at once, e.g. waiting for their body, each keep a block.
+	constexpr std::size_t threadBlockCount = 4;
+
+	// One of the calling thread's blocks, unless arenas of the thread already use all of them.
+	detail::RequestArenaBlock* acquireBlock()
+	{
+		thread_local std::array<detail::RequestArenaBlock, threadBlockCount> threadBlocks;
+		for (auto& block : threadBlocks) {
+			if (!block.inUse) {
+				block.inUse = true;
+				if (!block.data) {
+					block.data = std::make_unique<std::byte[]>(block.size);
+				}
+				return &block;
+			}
+		}
+		return nullptr;
+	}
+}
+
+void setRequestArenaHighWaterMark(std::size_t bytes)
+{
+	sizing.setHighWaterMark(bytes);
+}
+
+std::size_t getRequestArenaHighWaterMark()
+{
+	return sizing.getHighWaterMark();
+}
+
+RequestArena::RequestArena()
+: block{acquireBlock()}
+, upstream{}
+, arena{block ? std::pmr::monotonic_buffer_resource{block->data.get(), block->size, &upstream} : std::pmr::monotonic_buffer_resource{&upstream}}
+{}
+
+RequestArena::~RequestArena()
+{
+	arena.release();
+	if (!block) {
+		return;
+	}
+	block->inUse = false;
+	const std::size_t size = sizing.nextSize(block->size, block->size + upstream.allocated());
+	if (size != block->size) {
+		block->size = size;
+		block->data.reset();
+	}
+}
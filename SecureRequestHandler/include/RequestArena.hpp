@@ -0,0 +1,65 @@
+#ifndef REQUEST_ARENA_HPP
+#define REQUEST_ARENA_HPP
+
+#include <cstddef>
+#include <memory_resource>
+
+/**
+ * Per-request scratch memory, released all at once when the request is done.
+ *
+ * A RequestArena is a monotonic_buffer_resource whose first buffer is a block owned by the
+ * calling thread and reused by its successive requests, so that a request fitting in that
+ * block doesn't allocate at all. Allocations past the block come from the heap, and the
+ * block grows for the next requests accordingly, up to the high-water mark past which the
+ * extra memory is freed instead of retained. Each thread keeps a few blocks for the requests
+ * it has in progress at once, an arena created while all of them are in use starts from the
+ * heap instead.
+ */
+
+// The most memory retained by each arena block of a thread between requests, 64 KiB by default.
+void setRequestArenaHighWaterMark(std::size_t bytes);
+std::size_t getRequestArenaHighWaterMark();
+
+namespace detail
+{
+	struct RequestArenaBlock;
+
+	// Forwards to the heap, counting what the arena needed past its block.
+	class CountingResource : public std::pmr::memory_resource
+	{
+	public:
+		std::size_t allocated() const
+		{
+			return total;
+		}
+
+	private:
+		void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+		void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override;
+		bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+		std::size_t total = 0;
+	};
+}
+
+class RequestArena
+{
+public:
+	RequestArena();
+	~RequestArena();
+
+	RequestArena(const RequestArena&) = delete;
+	RequestArena& operator=(const RequestArena&) = delete;
+
+	std::pmr::memory_resource* resource()
+	{
+		return &arena;
+	}
+
+private:
+	detail::RequestArenaBlock* block;
+	detail::CountingResource upstream;
+	std::pmr::monotonic_buffer_resource arena;
+};
+
+#endif
@@ -0,0 +1,190 @@
+#ifndef REQUEST_CONTEXT_HPP
+#define REQUEST_CONTEXT_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include "HeaderKey.hpp"
+#include <memory>
+#include <memory_resource>
+#include <optional>
+#include "RequestAdapter.hpp"
+#include "RequestArena.hpp"
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace detail
+{
+	template <typename Adapter, typename Keys, typename = void>
+	struct hasHeadersLookup : std::false_type {};
+	template <typename Adapter, typename ... Keys>
+	struct hasHeadersLookup<Adapter, HeaderKeyList<Keys...>, std::void_t<decltype(Adapter::template getHeaders<Keys...>(std::declval<const typename Adapter::request_type&>()))>> : std::true_type {};
+}
+
+/**
+ * Lazily populated view over a request, shared by all the InputDesc of a handler.
+ *
+ * Sources read the request through the context so that the target is split once and
+ * every header is looked up once. Validators which accept a context as second parameter
+ * can also cache what they parse out of a source (a QueryString, a JSON document, ...)
+ * with parseOnce, so that each source is parsed at most once per request no matter how
+ * many inputs read it. Everything cached lives until the handler returns, which is why
+ * values may borrow from it (e.g. std::string_view members of a JSON document).
+ *
+ * The context's own bookkeeping, what parseOnce caches and the in-situ copies are allocated
+ * from a RequestArena released with the context. Validators may allocate their scratch
+ * memory from resource() as well.
+ *
+ * The context of a request waiting for its body is kept while the thread serves others, what
+ * it caches must then not hold per-thread memory (e.g. a DetachedJSON instead of a PooledJSON).
+ */
+template <typename RequestType>
+class RequestContext
+{
+public:
+	using request_adapter = RequestAdapter<RequestType>;
+	using request_type = RequestType;
+
+	explicit RequestContext(const request_type& req) : req{req} {}
+	
+	// When exclusiveBody is set, the body may be lent once to an in-situ parser instead of being copied.
+	// It is only looked up when lent, so that the context may be created before the body is received.
+	RequestContext(request_type& req, bool exclusiveBody)
+	: req{req}
+	, bodyOwner{exclusiveBody ? &req : nullptr}
+	{}
+
+	RequestContext(const RequestContext&) = delete;
+	RequestContext& operator=(const RequestContext&) = delete;
+
+	const request_type& request() const
+	{
+		return req;
+	}
+
+	std::pmr::memory_resource* resource()
+	{
+		return arena.resource();
+	}
+	
+	void setPending()
+	{
+		pending = true;
+	}
+	
+	bool isPending() const
+	{
+		return pending;
+	}
+
+	// Looks up the Keys all at once when the adapter supports it, instead of one at a time as they are read.
+	template <typename ... Keys>
+	void resolveHeaders(HeaderKeyList<Keys...> keys)
+	{
+		if constexpr (sizeof...(Keys) > 0 && detail::hasHeadersLookup<request_adapter, decltype(keys)>::value) {
+			const auto values = request_adapter::template getHeaders<Keys...>(req);
+			std::size_t i = 0;
+			(headers.emplace_back(headerKey<Keys>.name, values[i++]), ...);
+		}
+	}
+
+	std::string_view getHeader(std::string_view name)
+	{
+		for (const auto& header : headers) {
+			if (header.first == name) {
+				return header.second;
+			}
+		}
+		const auto value = request_adapter::getHeader(req, name);
+		headers.emplace_back(name, value);
+		return value;
+	}
+
+	std::string_view getBody()
+	{
+		return request_adapter::getBody(req);
+	}
+
+	std::string_view getPath()
+	{
+		return target().first;
+	}
+
+	std::string_view getQueryString()
+	{
+		return target().second;
+	}
+
+	std::string_view getVerb()
+	{
+		return request_adapter::getVerb(req);
+	}
+
+	// Returns the T built by init(T&, source) the first time it was requested for this source.
+	template <typename T, typename Init>
+	const T& parseOnce(std::string_view source, Init&& init)
+	{
+		const void* tag = &cacheTag<T>;
+		for (const auto& entry : cache) {
+			if (entry.tag == tag && entry.source.data() == source.data() && entry.source.size() == source.size()) {
+				return *static_cast<const T*>(entry.value.get());
+			}
+		}
+		// Allocator-aware values (e.g. a QueryString) allocate their elements from the arena too.
+		std::pmr::polymorphic_allocator<T> allocator{arena.resource()};
+		T* value = allocator.allocate(1);
+		allocator.construct(value);
+		// The arena releases the memory, only the destructor is left to run.
+		cache.push_back(CacheEntry{tag, source, erased_ptr{value, [](void* p) {
+			static_cast<T*>(p)->~T();
+		}}});
+		init(*value, source);
+		return *value;
+	}
+
+	// Mutable and null-terminated characters of source, for parsers writing decoded strings in place.
+	// The body is lent as is when no other input reads it, anything else is copied for each call.
+	char* insituBuffer(std::string_view source)
+	{
+		if (bodyOwner && source.data() == getBody().data() && source.size() == getBody().size()) {
+			return request_adapter::getMutableBody(*std::exchange(bodyOwner, nullptr));
+		}
+		auto copy = static_cast<char*>(arena.resource()->allocate(source.size() + 1, alignof(char)));
+		std::copy(source.begin(), source.end(), copy);
+		copy[source.size()] = '\0';
+		return copy;
+	}
+	
+private:
+	using erased_ptr = std::unique_ptr<void, void (*)(void*)>;
+
+	struct CacheEntry
+	{
+		const void* tag;
+		std::string_view source;
+		erased_ptr value;
+	};
+
+	template <typename T>
+	constexpr static char cacheTag = 0;
+
+	const std::pair<std::string_view, std::string_view>& target()
+	{
+		if (!splitTarget) {
+			splitTarget = request_adapter::splitTarget(req);
+		}
+		return *splitTarget;
+	}
+
+	// Declared first so that it outlives everything allocated from it.
+	RequestArena arena;
+	const request_type& req;
+	request_type* bodyOwner = nullptr;
+	bool pending = false;
+	std::optional<std::pair<std::string_view, std::string_view>> splitTarget;
+	std::pmr::vector<std::pair<std::string_view, std::string_view>> headers{arena.resource()};
+	std::pmr::vector<CacheEntry> cache{arena.resource()};
+};
+
+#endif
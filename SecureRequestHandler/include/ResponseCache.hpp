@@ -0,0 +1,345 @@
+#ifndef RESPONSE_CACHE_HPP
+#define RESPONSE_CACHE_HPP
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include "Metrics.hpp"
+#include <memory>
+#include <mutex>
+#include <optional>
+#include "RequestContext.hpp"
+#include "SecureRequestHandler.hpp"
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+
+/**
+ * Caches the responses of handlers which are pure functions of their inputs.
+ *
+ * A CachedRequestHandler keys its responses by the text its inputs are read from (the
+ * header values, the query string, the body ...). Validators only depend on that text, so
+ * a request whose inputs read the same text as a cached one would be validated into the
+ * same values and is answered with the cached response, without validating its inputs nor
+ * invoking the handler. When its inputs don't read the body, a request is looked up as soon
+ * as its header is received. Only the responses the request adapter deems cacheable are
+ * stored (e.g. 2xx statuses for Boost::Beast), rejected inputs are never cached. Caching
+ * requires RequestAdapter to define a cached_response_type, constructible from the handler's
+ * response and sharing its body with its copies (e.g. BeastSharedResponse), and
+ * isCacheable(response), responseSize(response) and prepareCachedResponse(response, req).
+ *
+ * The cache is split in shards, each a least recently used list behind its own mutex.
+ * Responses expire after a time to live, and the least recently used ones are evicted once
+ * the keys and responses exceed the memory budget. Copies of a CachedRequestHandler (e.g.
+ * the one a Router holds) share its cache. A shared body compressed for a response (see
+ * SharedBody) keeps its compressed variants for the next ones, outside of the budget.
+ *
+ * Usage example :
+ *
+
+ auto customers = makeCachedRequestHandler(
+	 makeBeastRequestHandler<OutputDesc<Customer, JSONSerializer>, InputDesc<int, QueryStringParam, GenericValidator>>(findCustomer),
+	 ResponseCacheOptions{std::chrono::seconds{10}, 16 * 1024 * 1024}
+ );
+
+ *
+ */
+
+struct ResponseCacheOptions
+{
+	// Responses older than this are not served anymore.
+	std::chrono::steady_clock::duration ttl = std::chrono::seconds{60};
+	// Budget of the cached keys and responses, shared evenly by the shards.
+	std::size_t maxBytes = 64 * 1024 * 1024;
+};
+
+template <typename Response>
+class ResponseCache
+{
+public:
+	using clock_type = std::chrono::steady_clock;
+
+	constexpr static std::size_t shardCount = 16;
+
+	explicit ResponseCache(ResponseCacheOptions options = {})
+	: options{options}
+	, counters{std::make_shared<CacheMetrics>()}
+	{}
+
+	ResponseCache(const ResponseCache&) = delete;
+	ResponseCache& operator=(const ResponseCache&) = delete;
+
+	// The cached response, shared so that it is copied out of the shard's lock.
+	std::shared_ptr<const Response> find(std::string_view key)
+	{
+		auto& shard = shardOf(key);
+		std::lock_guard<std::mutex> lock{shard.mutex};
+		const auto it = shard.index.find(key);
+		if (it == shard.index.end()) {
+			counters->recordMiss();
+			return nullptr;
+		}
+		const auto entry = it->second;
+		if (entry->expires <= clock_type::now()) {
+			remove(shard, entry, true);
+			counters->recordMiss();
+			return nullptr;
+		}
+		shard.entries.splice(shard.entries.begin(), shard.entries, entry);
+		counters->recordHit();
+		return entry->response;
+	}
+
+	// bytes is the size of the response, responses larger than a shard's budget are not cached.
+	void insert(std::string key, Response response, std::size_t bytes)
+	{
+		bytes += key.size();
+		const std::size_t budget = options.maxBytes / shardCount;
+		if (bytes > budget) {
+			return;
+		}
+		auto& shard = shardOf(key);
+		auto cached = std::make_shared<const Response>(std::move(response));
+		std::lock_guard<std::mutex> lock{shard.mutex};
+		const auto it = shard.index.find(key);
+		if (it != shard.index.end()) {
+			// Another thread missed the same key meanwhile, its response is just as good unless it expired.
+			if (it->second->expires > clock_type::now()) {
+				return;
+			}
+			remove(shard, it->second, true);
+		}
+		shard.entries.push_front(Entry{std::move(key), std::move(cached), clock_type::now() + options.ttl, bytes});
+		shard.index.emplace(shard.entries.front().key, shard.entries.begin());
+		shard.bytes += bytes;
+		counters->recordInsertion(bytes);
+		while (shard.bytes > budget) {
+			remove(shard, std::prev(shard.entries.end()), false);
+		}
+	}
+
+	std::shared_ptr<const CacheMetrics> metrics() const
+	{
+		return counters;
+	}
+
+private:
+	struct Entry
+	{
+		std::string key;
+		std::shared_ptr<const Response> response;
+		clock_type::time_point expires;
+		std::size_t bytes;
+	};
+
+	struct alignas(64) Shard
+	{
+		std::mutex mutex;
+		// Most recently used first.
+		std::list<Entry> entries;
+		// Keys are views of the entries' own keys.
+		std::unordered_map<std::string_view, typename std::list<Entry>::iterator> index;
+		std::size_t bytes = 0;
+	};
+
+	Shard& shardOf(std::string_view key)
+	{
+		return shards[std::hash<std::string_view>{}(key) % shardCount];
+	}
+
+	void remove(Shard& shard, typename std::list<Entry>::iterator entry, bool expired)
+	{
+		shard.bytes -= entry->bytes;
+		counters->recordRemoval(entry->bytes, expired);
+		shard.index.erase(entry->key);
+		shard.entries.erase(entry);
+	}
+
+	ResponseCacheOptions options;
+	std::shared_ptr<CacheMetrics> counters;
+	std::array<Shard, shardCount> shards;
+};
+
+namespace detail
+{
+	// Each part is prefixed with its size, so that the parts can't run into one another.
+	inline void appendCacheKeyPart(std::string& key, std::string_view part)
+	{
+		const auto size = static_cast<std::uint32_t>(part.size());
+		key.append(reinterpret_cast<const char*>(&size), sizeof(size));
+		key.append(part);
+	}
+
+	template <typename RequestType, typename ... Inputs>
+	void appendCacheKey(std::string& key, RequestContext<RequestType>& ctx, std::tuple<Inputs...>*)
+	{
+		(appendCacheKeyPart(key, typename Inputs::source_type{}(ctx)), ...);
+	}
+
+	template <typename ... Inputs>
+	constexpr bool readsBody(std::tuple<Inputs...>*)
+	{
+		return (std::is_same_v<typename Inputs::source_type, BodyParam> || ...);
+	}
+
+	// What a CachedRequestHandler keeps of a request once its header is received : the cached
+	// response, or the key its response is stored under and the pending request of the handler.
+	template <typename Handler, typename Response>
+	struct CachedPendingRequest
+	{
+		std::optional<Response> cached;
+		std::string key;
+		std::optional<typename Handler::pending_request_type> handler;
+	};
+}
+
+template <typename Handler>
+struct CachedRequestHandler : Handler
+{
+	using request_adapter = typename Handler::request_adapter;
+	using request_type = typename request_adapter::request_type;
+	using response_type = typename request_adapter::cached_response_type;
+	using cache_type = ResponseCache<response_type>;
+	using body_checker_type = typename detail::handlerBodyChecker<Handler>::type;
+	using pending_request_type = detail::CachedPendingRequest<Handler, response_type>;
+
+	static_assert(std::is_constructible_v<response_type, typename Handler::response_type&&>, "Streamed responses can't be cached.");
+
+	CachedRequestHandler(Handler handler, ResponseCacheOptions options = {})
+	: Handler(std::move(handler))
+	, cache{std::make_shared<cache_type>(options)}
+	{}
+
+	response_type operator()(const request_type& req) const
+	{
+		return respond(req);
+	}
+
+	response_type operator()(request_type& req) const
+	{
+		return respond(req);
+	}
+
+	// Unless the inputs read the body, the cache is looked up as soon as the header is received. Otherwise,
+	// it is looked up once the body is received. Either way, the inputs of a cached request are not
+	// validated at all, those of other requests are validated once the cache missed.
+	std::optional<typename request_adapter::status_type> validateHeaders(request_type& req, std::optional<pending_request_type>& pending) const
+	{
+		auto& current = pending.emplace();
+		current.handler.emplace(req, this->observer);
+		if constexpr (readsBody) {
+			return std::nullopt;
+		} else {
+			if (lookup(req, current)) {
+				return std::nullopt;
+			}
+			return Handler::validatePendingHeaders(current.handler);
+		}
+	}
+
+	// Only the inputs reading the body have a checker, and the key of their request is only known once
+	// the body is received : every body is checked, those of cached requests pass.
+	body_checker_type bodyChecker(const request_type& req) const
+	{
+		if constexpr (readsBody) {
+			return Handler::bodyChecker(req);
+		} else {
+			return body_checker_type{};
+		}
+	}
+
+	response_type operator()(const request_type& req, pending_request_type& pending) const
+	{
+		if (pending.cached) {
+			return std::move(*pending.cached);
+		}
+		if constexpr (readsBody) {
+			return respond(req, pending);
+		} else {
+			return store(std::move(pending.key), Handler::operator()(req, *pending.handler));
+		}
+	}
+
+	// The header inputs are only validated on a miss, when they reject req they are reported instead of the body.
+	void rejectBody(const request_type& req, pending_request_type& pending) const
+	{
+		if constexpr (readsBody) {
+			if (!Handler::validatePendingHeaders(pending.handler)) {
+				Handler::rejectBody(req, *pending.handler);
+			}
+		}
+	}
+
+	// Renders the counters of the cache under name, along with the handler's metrics if it records them.
+	void enableMetrics(std::string_view name, MetricsRegistry& registry = MetricsRegistry::global())
+	{
+		if constexpr (detail::hasMetrics<Handler>::value) {
+			Handler::enableMetrics(name, registry);
+		}
+		registry.addCache(name, cache->metrics());
+	}
+
+	std::shared_ptr<cache_type> cache;
+
+private:
+	constexpr static bool readsBody = detail::readsBody(static_cast<typename Handler::input_types*>(nullptr));
+
+	// Requests handled at once, e.g. pipelined ones, read their key from the context their inputs are validated in.
+	template <typename Request>
+	response_type respond(Request& req) const
+	{
+		pending_request_type pending;
+		pending.handler.emplace(req, this->observer);
+		return respond(req, pending);
+	}
+
+	response_type respond(const request_type& req, pending_request_type& pending) const
+	{
+		if (lookup(req, pending)) {
+			return std::move(*pending.cached);
+		}
+		if (const auto rejection = Handler::validatePendingHeaders(pending.handler)) {
+			return typename Handler::make_response_type{req}(*rejection);
+		}
+		return store(std::move(pending.key), Handler::operator()(req, *pending.handler));
+	}
+
+	// Leaves the cached response of req in pending, or the key its response is to be stored under.
+	bool lookup(const request_type& req, pending_request_type& pending) const
+	{
+		// Reused by the thread's requests, a key is only copied when it misses.
+		thread_local std::string key;
+		key.clear();
+		detail::appendCacheKey(key, pending.handler->ctx, static_cast<typename Handler::input_types*>(nullptr));
+		if (const auto cached = cache->find(key)) {
+			pending.cached.emplace(*cached);
+			request_adapter::prepareCachedResponse(*pending.cached, req);
+			pending.handler.reset();
+			return true;
+		}
+		pending.key = key;
+		return false;
+	}
+
+	response_type store(std::string key, response_type response) const
+	{
+		if (request_adapter::isCacheable(response)) {
+			cache->insert(std::move(key), response, request_adapter::responseSize(response));
+		}
+		return response;
+	}
+};
+
+template <typename Handler>
+CachedRequestHandler<std::decay_t<Handler>> makeCachedRequestHandler(Handler&& handler, ResponseCacheOptions options = {})
+{
+	return CachedRequestHandler<std::decay_t<Handler>>{std::forward<Handler>(handler), options};
+}
+
+#endif
@@ -0,0 +1,481 @@
+#ifndef ROUTER_HPP
+#define ROUTER_HPP
+
+#include <array>
+#include "BodyChecker.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include "Metrics.hpp"
+#include "RequestAdapter.hpp"
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+/**
+ * Syntax summary :
+ *   Router<Route<Verb, Path, Handler> ...>
+ *   Verb and Path are typestrings, e.g. typestring_is("GET") and typestring_is("/customers")
+ *   Handler is a RequestHandler (or anything exposing request_adapter and make_response_type)
+ *
+ * Every "path verb" key is inserted in a trie when the program is compiled. Dispatching
+ * walks the trie once per character of the request's path and verb, without allocating
+ * and without comparing strings. Unknown paths are answered with NotFound and known paths
+ * requested with another verb are answered with MethodNotAllowed, along with the verbs of the
+ * path's routes (the Allow header of Boost::Beast responses), also joined when compiling.
+ *
+ * Usage example :
+ *
+
+ Router<
+	 Route<typestring_is("GET"), typestring_is("/customers"), decltype(listCustomers)>,
+	 Route<typestring_is("POST"), typestring_is("/customers"), decltype(addCustomer)>
+ > router{listCustomers, addCustomer};
+
+ *
+ */
+
+template <typename Verb, typename Path, typename Handler>
+struct Route
+{
+	using verb_type = Verb;
+	using path_type = Path;
+	using handler_type = Handler;
+};
+
+namespace detail
+{
+	constexpr std::size_t noRoute = static_cast<std::size_t>(-1);
+
+	// Edges leaving node n are edgeChars[edgeOffsets[n] .. edgeOffsets[n + 1]), sorted by character.
+	template <std::size_t Capacity>
+	struct RouteTrie
+	{
+		std::array<char, Capacity> edgeChars{};
+		std::array<std::uint32_t, Capacity> edgeTargets{};
+		std::array<std::uint32_t, Capacity + 1> edgeOffsets{};
+		std::array<std::size_t, Capacity> routes{};
+		// A route of the path each separator node ends, for the verbs allowed on that path.
+		std::array<std::size_t, Capacity> pathRoutes{};
+		bool hasDuplicates = false;
+
+		constexpr std::size_t child(std::size_t node, char c) const
+		{
+			std::size_t first = edgeOffsets[node];
+			std::size_t last = edgeOffsets[node + 1];
+			const std::size_t end = last;
+			while (first < last) {
+				const std::size_t middle = first + (last - first) / 2;
+				if (edgeChars[middle] < c) {
+					first = middle + 1;
+				} else {
+					last = middle;
+				}
+			}
+			if (first != end && edgeChars[first] == c) {
+				return edgeTargets[first];
+			}
+			return noRoute;
+		}
+	};
+
+	template <std::size_t Capacity, std::size_t RouteCount>
+	constexpr RouteTrie<Capacity> makeRouteTrie(const std::array<std::string_view, RouteCount>& paths, const std::array<std::string_view, RouteCount>& verbs)
+	{
+		// Build a first-child/next-sibling trie, then flatten it into RouteTrie's sorted edge lists.
+		// Node 0 is the root, it is never anyone's child so 0 also means "no node" below.
+		std::array<char, Capacity> chars{};
+		std::array<std::size_t, Capacity> firstChild{};
+		std::array<std::size_t, Capacity> nextSibling{};
+		std::size_t nodeCount = 1;
+		RouteTrie<Capacity> trie{};
+		for (std::size_t i = 0; i < Capacity; ++i) {
+			trie.routes[i] = noRoute;
+			trie.pathRoutes[i] = noRoute;
+		}
+
+		auto step = [&](std::size_t node, char c) -> std::size_t {
+			std::size_t previous = 0;
+			std::size_t current = firstChild[node];
+			while (current != 0 && chars[current] < c) {
+				previous = current;
+				current = nextSibling[current];
+			}
+			if (current != 0 && chars[current] == c) {
+				return current;
+			}
+			const std::size_t created = nodeCount++;
+			chars[created] = c;
+			nextSibling[created] = current;
+			if (previous == 0) {
+				firstChild[node] = created;
+			} else {
+				nextSibling[previous] = created;
+			}
+			return created;
+		};
+
+		for (std::size_t route = 0; route < RouteCount; ++route) {
+			std::size_t node = 0;
+			for (char c : paths[route]) {
+				node = step(node, c);
+			}
+			node = step(node, ' ');
+			trie.pathRoutes[node] = route;
+			for (char c : verbs[route]) {
+				node = step(node, c);
+			}
+			if (trie.routes[node] != noRoute) {
+				trie.hasDuplicates = true;
+			}
+			trie.routes[node] = route;
+		}
+
+		std::size_t edge = 0;
+		for (std::size_t node = 0; node < nodeCount; ++node) {
+			trie.edgeOffsets[node] = static_cast<std::uint32_t>(edge);
+			for (std::size_t c = firstChild[node]; c != 0; c = nextSibling[c]) {
+				trie.edgeChars[edge] = chars[c];
+				trie.edgeTargets[edge] = static_cast<std::uint32_t>(c);
+				++edge;
+			}
+		}
+		for (std::size_t node = nodeCount; node <= Capacity; ++node) {
+			trie.edgeOffsets[node] = static_cast<std::uint32_t>(edge);
+		}
+		return trie;
+	}
+
+	// The verbs of the routes sharing each route's path, joined as an Allow header lists them.
+	template <std::size_t Capacity, std::size_t RouteCount>
+	struct RouteVerbs
+	{
+		std::array<char, Capacity> text{};
+		std::array<std::size_t, RouteCount> offsets{};
+		std::array<std::size_t, RouteCount> sizes{};
+
+		constexpr std::string_view operator[](std::size_t route) const
+		{
+			return std::string_view{text.data() + offsets[route], sizes[route]};
+		}
+	};
+
+	template <std::size_t Capacity, std::size_t RouteCount>
+	constexpr RouteVerbs<Capacity, RouteCount> makeRouteVerbs(const std::array<std::string_view, RouteCount>& paths, const std::array<std::string_view, RouteCount>& verbs)
+	{
+		RouteVerbs<Capacity, RouteCount> routeVerbs{};
+		std::size_t size = 0;
+		for (std::size_t route = 0; route < RouteCount; ++route) {
+			// Routes of the same path share the text of the first one.
+			std::size_t first = 0;
+			while (paths[first] != paths[route]) {
+				++first;
+			}
+			if (first < route) {
+				routeVerbs.offsets[route] = routeVerbs.offsets[first];
+				routeVerbs.sizes[route] = routeVerbs.sizes[first];
+				continue;
+			}
+			routeVerbs.offsets[route] = size;
+			for (std::size_t other = route; other < RouteCount; ++other) {
+				if (paths[other] != paths[route]) {
+					continue;
+				}
+				if (size > routeVerbs.offsets[route]) {
+					routeVerbs.text[size++] = ',';
+					routeVerbs.text[size++] = ' ';
+				}
+				for (char c : verbs[other]) {
+					routeVerbs.text[size++] = c;
+				}
+			}
+			routeVerbs.sizes[route] = size - routeVerbs.offsets[route];
+		}
+		return routeVerbs;
+	}
+
+	// Handlers validating the header of a request before its body is received, see BasicRequestHandler.
+	template <typename Handler, typename = void>
+	struct hasHeaderValidation : std::false_type {};
+	template <typename Handler>
+	struct hasHeaderValidation<Handler, std::void_t<typename Handler::pending_request_type>> : std::true_type {};
+
+	// What a route keeps of a request whose header it validated, nothing for handlers which don't.
+	template <typename Handler, bool = hasHeaderValidation<Handler>::value>
+	struct routePending
+	{
+		using type = std::monostate;
+	};
+	template <typename Handler>
+	struct routePending<Handler, true>
+	{
+		using type = std::optional<typename Handler::pending_request_type>;
+	};
+
+	template <typename ... Routes>
+	struct RouteTable
+	{
+		// One node per character of every key, plus the separator and the root.
+		constexpr static std::size_t capacity = 1 + ((Routes::path_type::size() + 1 + Routes::verb_type::size()) + ... + 0);
+		constexpr static std::array<std::string_view, sizeof...(Routes)> paths = {
+			std::string_view{Routes::path_type::data(), Routes::path_type::size()}...
+		};
+		constexpr static std::array<std::string_view, sizeof...(Routes)> verbs = {
+			std::string_view{Routes::verb_type::data(), Routes::verb_type::size()}...
+		};
+		constexpr static RouteTrie<capacity> trie = makeRouteTrie<capacity>(paths, verbs);
+		// Every verb and its separator, at most once.
+		constexpr static std::size_t verbsCapacity = ((Routes::verb_type::size() + 2) + ... + 0);
+		constexpr static RouteVerbs<verbsCapacity, sizeof...(Routes)> pathVerbs = makeRouteVerbs<verbsCapacity>(paths, verbs);
+
+		static_assert(!trie.hasDuplicates, "Two routes share the same verb and path.");
+	};
+}
+
+template <typename ... Routes>
+class Router
+{
+	static_assert(sizeof...(Routes) > 0, "A Router requires at least one Route.");
+
+	using first_handler_type = std::tuple_element_t<0, std::tuple<typename Routes::handler_type...>>;
+	using route_table = detail::RouteTable<Routes...>;
+
+public:
+	using request_adapter = typename first_handler_type::request_adapter;
+	using request_type = typename request_adapter::request_type;
+	// Routes may produce different responses as long as they convert to a common one (e.g. whole and streamed).
+	using response_type = std::common_type_t<typename Routes::handler_type::response_type...>;
+
+	static_assert((std::is_same_v<typename Routes::handler_type::request_adapter, request_adapter> && ...), "All routes must handle the same RequestType.");
+
+	Router(typename Routes::handler_type ... handlers) : handlers{std::move(handlers)...} {}
+
+	response_type operator()(const request_type& req) const
+	{
+		return dispatch(req);
+	}
+
+	// Forwards a mutable request so that handlers may parse its body in place.
+	response_type operator()(request_type& req) const
+	{
+		return dispatch(req);
+	}
+
+	using body_checker_type = AnyBodyChecker<typename detail::handlerBodyChecker<typename Routes::handler_type>::type...>;
+
+	// The checker of the route handling req, as soon as its header is received.
+	body_checker_type bodyChecker(const request_type& req) const
+	{
+		constexpr static auto checkerTable = makeCheckerTable(std::index_sequence_for<Routes...>{});
+		const auto route = findRoute(req).route;
+		if (route == detail::noRoute) {
+			return body_checker_type{};
+		}
+		return checkerTable[route]();
+	}
+
+	// The index of the alternative is the route the header of the request was validated for.
+	using pending_request_type = std::variant<typename detail::routePending<typename Routes::handler_type>::type...>;
+
+	// Rejects unknown routes, and requests whose route rejects the inputs read from the header.
+	std::optional<typename request_adapter::status_type> validateHeaders(request_type& req, std::optional<pending_request_type>& pending) const
+	{
+		using validation_type = std::optional<typename request_adapter::status_type> (*)(const Router&, request_type&, std::optional<pending_request_type>&);
+		constexpr static auto validationTable = makeValidationTable<validation_type>(std::index_sequence_for<Routes...>{});
+		const auto match = findRoute(req);
+		if (match.route == detail::noRoute) {
+			return match.status;
+		}
+		return validationTable[match.route](*this, req, pending);
+	}
+
+	// Invokes the route validateHeaders found, without looking it up again.
+	response_type operator()(request_type& req, pending_request_type& pending) const
+	{
+		using pending_dispatch_type = response_type (*)(const Router&, request_type&, pending_request_type&);
+		constexpr static auto pendingDispatchTable = makePendingDispatchTable<pending_dispatch_type>(std::index_sequence_for<Routes...>{});
+		return pendingDispatchTable[pending.index()](*this, req, pending);
+	}
+
+	// Forwards the rejection of the body by the checker to the route which validated the header.
+	void rejectBody(const request_type& req, pending_request_type& pending) const
+	{
+		using rejection_type = void (*)(const Router&, const request_type&, pending_request_type&);
+		constexpr static auto rejectionTable = makeRejectionTable<rejection_type>(std::index_sequence_for<Routes...>{});
+		rejectionTable[pending.index()](*this, req, pending);
+	}
+
+	// The verbs of the routes of req's path, which a MethodNotAllowed response lists.
+	static std::string_view allowedVerbs(const request_type& req)
+	{
+		return findRoute(req).allowedVerbs;
+	}
+
+	// Enables the metrics of every route's handler observed by MetricsObserver, named after the route, e.g. "GET /customers".
+	void enableMetrics(MetricsRegistry& registry = MetricsRegistry::global())
+	{
+		enableMetrics(registry, std::index_sequence_for<Routes...>{});
+	}
+
+private:
+	template <std::size_t ... Is>
+	void enableMetrics(MetricsRegistry& registry, std::index_sequence<Is...>)
+	{
+		(enableRouteMetrics<Is>(registry), ...);
+	}
+
+	template <std::size_t I>
+	void enableRouteMetrics(MetricsRegistry& registry)
+	{
+		auto& handler = std::get<I>(handlers);
+		if constexpr (detail::hasMetrics<std::decay_t<decltype(handler)>>::value) {
+			std::string name{route_table::verbs[I]};
+			name.append(" ").append(route_table::paths[I]);
+			handler.enableMetrics(name, registry);
+		}
+	}
+
+	template <typename Request>
+	response_type dispatch(Request& req) const
+	{
+		using dispatch_type = response_type (*)(const Router&, Request&);
+		constexpr static auto dispatchTable = makeDispatchTable<dispatch_type, Request>(std::index_sequence_for<Routes...>{});
+
+		const auto match = findRoute(req);
+		if (match.route == detail::noRoute) {
+			return respond(req, match);
+		}
+		return dispatchTable[match.route](*this, req);
+	}
+
+	struct RouteMatch
+	{
+		// noRoute unless a route handles the request.
+		std::size_t route;
+		typename request_adapter::status_type status;
+		// The verbs of the path's routes, for MethodNotAllowed.
+		std::string_view allowedVerbs;
+	};
+
+	static RouteMatch findRoute(const request_type& req)
+	{
+		constexpr const auto& trie = route_table::trie;
+
+		std::size_t node = 0;
+		for (char c : request_adapter::getPath(req)) {
+			node = trie.child(node, c);
+			if (node == detail::noRoute) {
+				return {detail::noRoute, request_adapter::NotFound, {}};
+			}
+		}
+		node = trie.child(node, ' ');
+		if (node == detail::noRoute) {
+			return {detail::noRoute, request_adapter::NotFound, {}};
+		}
+		const std::string_view allowedVerbs = route_table::pathVerbs[trie.pathRoutes[node]];
+		for (char c : request_adapter::getVerb(req)) {
+			node = trie.child(node, c);
+			if (node == detail::noRoute) {
+				return {detail::noRoute, request_adapter::MethodNotAllowed, allowedVerbs};
+			}
+		}
+		const std::size_t route = trie.routes[node];
+		if (route == detail::noRoute) {
+			return {detail::noRoute, request_adapter::MethodNotAllowed, allowedVerbs};
+		}
+		return {route, request_adapter::Ok, allowedVerbs};
+	}
+
+	template <typename ValidationType, std::size_t ... Is>
+	constexpr static std::array<ValidationType, sizeof...(Is)> makeValidationTable(std::index_sequence<Is...>)
+	{
+		return {{&Router::validate<Is>...}};
+	}
+
+	template <std::size_t I>
+	static std::optional<typename request_adapter::status_type> validate(const Router& router, request_type& req, std::optional<pending_request_type>& pending)
+	{
+		const auto& handler = std::get<I>(router.handlers);
+		auto& current = pending.emplace(std::in_place_index<I>);
+		if constexpr (detail::hasHeaderValidation<std::decay_t<decltype(handler)>>::value) {
+			const auto rejection = handler.validateHeaders(req, std::get<I>(current));
+			if (rejection) {
+				pending.reset();
+			}
+			return rejection;
+		} else {
+			return std::nullopt;
+		}
+	}
+
+	template <typename RejectionType, std::size_t ... Is>
+	constexpr static std::array<RejectionType, sizeof...(Is)> makeRejectionTable(std::index_sequence<Is...>)
+	{
+		return {{&Router::rejectPendingBody<Is>...}};
+	}
+
+	template <std::size_t I>
+	static void rejectPendingBody(const Router& router, const request_type& req, pending_request_type& pending)
+	{
+		if constexpr (detail::hasHeaderValidation<std::tuple_element_t<I, std::tuple<typename Routes::handler_type...>>>::value) {
+			std::get<I>(router.handlers).rejectBody(req, *std::get<I>(pending));
+		}
+	}
+
+	template <typename DispatchType, std::size_t ... Is>
+	constexpr static std::array<DispatchType, sizeof...(Is)> makePendingDispatchTable(std::index_sequence<Is...>)
+	{
+		return {{&Router::invokePending<Is>...}};
+	}
+
+	template <std::size_t I>
+	static response_type invokePending(const Router& router, request_type& req, pending_request_type& pending)
+	{
+		const auto& handler = std::get<I>(router.handlers);
+		if constexpr (detail::hasHeaderValidation<std::decay_t<decltype(handler)>>::value) {
+			return handler(req, *std::get<I>(pending));
+		} else {
+			return handler(req);
+		}
+	}
+
+	template <std::size_t ... Is>
+	constexpr static std::array<body_checker_type (*)(), sizeof...(Is)> makeCheckerTable(std::index_sequence<Is...>)
+	{
+		return {{&Router::makeChecker<Is>...}};
+	}
+
+	template <std::size_t I>
+	static body_checker_type makeChecker()
+	{
+		return body_checker_type{std::in_place_index<I + 1>};
+	}
+
+	template <typename DispatchType, typename Request, std::size_t ... Is>
+	constexpr static std::array<DispatchType, sizeof...(Is)> makeDispatchTable(std::index_sequence<Is...>)
+	{
+		return {{&Router::invoke<Is, Request>...}};
+	}
+
+	template <std::size_t I, typename Request>
+	static response_type invoke(const Router& router, Request& req)
+	{
+		return std::get<I>(router.handlers)(req);
+	}
+
+	static response_type respond(const request_type& req, const RouteMatch& match)
+	{
+		auto response = typename first_handler_type::make_response_type{req}(match.status);
+		if (match.status == request_adapter::MethodNotAllowed) {
+			request_adapter::setAllowedVerbs(response, match.allowedVerbs);
+		}
+		return response;
+	}
+
+	std::tuple<typename Routes::handler_type...> handlers;
+};
+
+#endif
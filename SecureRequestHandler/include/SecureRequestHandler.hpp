@@ -1,16 +1,24 @@
 #ifndef SECURE_REQUEST_HANDLER_HPP
 #define SECURE_REQUEST_HANDLER_HPP
 
+#include "BodyChecker.hpp"
+#include "ETag.hpp"
+#include <functional>
 #include "GenericSerializer.hpp"
 #include "GenericValidator.hpp"
+#include "HeaderKey.hpp"
+#include "JSONSAXValidator.hpp"
 #include "JSONSerializer.hpp"
 #include "JSONValidator.hpp"
+#include "Metrics.hpp"
 #include <optional>
 #include "QueryStringSerializer.hpp"
 #include "QueryStringValidator.hpp"
 #include "RequestAdapter.hpp"
+#include "RequestContext.hpp"
 #include <string>
 #include <string_view>
+#include "StreamedOutput.hpp"
 #include <tuple>
 #include <type_traits>
 #include "typestring.h"
@@ -18,13 +26,21 @@
 /**
  * Syntax summary :
  *   RequestHandler<RequestType, SendType, OutputDesc, InputDesc ...>
+ *   makeRequestHandler<RequestType, OutputDesc, InputDesc ...>(handler)
+ *   ObservedRequestHandler<RequestType, Observer, OutputDesc, InputDesc ...>
+ *   makeRequestHandler<RequestType, OutputDesc, InputDesc ...>(handler, observer)
  *   RequestType is specific to your HTTP library,
  *               RequestAdapter must be specialized with RequestType
  *   SendType is a type that can be invoked to send a response, it is specific to your
  *            HTTP library and RequestAdapter must be specialized to use it
  *   OutputDesc<ContentType, GenericSerializer>
+ *   StreamedOutputDesc<ElementType, JSONStreamSerializer>
+ *   ETagOutputDesc<ContentType, GenericSerializer>
  *   InputDesc<ValueType, Source, GenericValidator>
  *   InputDesc<ValueType, Source, JSONValidator>
+ *   InputDesc<ValueType, Source, JSONSAXValidator>
+ *   InputDesc<ValueType, Source, JSONInsituValidator>
+ *   InputDesc<ValueType, Source, JSONSAXInsituValidator>
  *   InputDesc<ValueType, Source, QueryStringValidator>
  *   Source => HeaderParam<typestring_is("host")> | BodyParam | VerbParam | PathParam
  * Usage example :
@@ -55,12 +71,10 @@ struct HeaderParam
 	template <typename T>
 	using default_validator_type = GenericValidator<T>;
 	
-	template <typename RequestType>
-	std::string_view operator()(const RequestType& req) const
+	template <typename Context>
+	std::string_view operator()(Context& ctx) const
 	{
-		Key key;
-		const auto name = std::string_view{key.data(), key.size()};
-		return RequestAdapter<RequestType>::getHeader(req, name);
+		return ctx.getHeader(headerKey<Key>.name);
 	}
 };
 struct PathParam
@@ -68,10 +82,10 @@ struct PathParam
 	template <typename T>
 	using default_validator_type = GenericValidator<T>;
 	
-	template <typename RequestType>
-	std::string_view operator()(const RequestType& req) const
+	template <typename Context>
+	std::string_view operator()(Context& ctx) const
 	{
-		return RequestAdapter<RequestType>::getPath(req);
+		return ctx.getPath();
 	}
 };
 struct QueryStringParam
@@ -79,10 +93,10 @@ struct QueryStringParam
 	template <typename T>
 	using default_validator_type = QueryStringValidator<T>;
 	
-	template <typename RequestType>
-	std::string_view operator()(const RequestType& req) const
+	template <typename Context>
+	std::string_view operator()(Context& ctx) const
 	{
-		return RequestAdapter<RequestType>::getQueryString(req);
+		return ctx.getQueryString();
 	}
 };
 struct VerbParam
@@ -90,10 +104,10 @@ struct VerbParam
 	template <typename T>
 	using default_validator_type = GenericValidator<T>;
 	
-	template <typename RequestType>
-	std::string_view operator()(const RequestType& req) const
+	template <typename Context>
+	std::string_view operator()(Context& ctx) const
 	{
-		return RequestAdapter<RequestType>::getVerb(req);
+		return ctx.getVerb();
 	}
 };
 struct BodyParam
@@ -101,10 +115,10 @@ struct BodyParam
 	template <typename T>
 	using default_validator_type = GenericValidator<T>;
 	
-	template <typename RequestType>
-	std::string_view operator()(const RequestType& req) const
+	template <typename Context>
+	std::string_view operator()(Context& ctx) const
 	{
-		return RequestAdapter<RequestType>::getBody(req);
+		return ctx.getBody();
 	}
 };
 
@@ -115,6 +129,22 @@ struct OutputDesc
 	using serializer_type = Serializer<T>;
 };
 
+// The handler answers with a range or a generator of T, sent in batches as they are serialized.
+template <typename T, template <typename> typename Serializer = JSONStreamSerializer>
+struct StreamedOutputDesc
+{
+	using value_type = T;
+	using serializer_type = StreamedSerializer<Serializer<T>>;
+};
+
+// Successful responses carry an entity tag of their body, and requests whose If-None-Match matches it are answered 304 Not Modified, see ETag.hpp.
+template <typename T, template <typename> typename Serializer = GenericSerializer>
+struct ETagOutputDesc
+{
+	using value_type = T;
+	using serializer_type = ETagSerializer<Serializer<T>>;
+};
+
 template <typename T, typename Source, template <typename> typename Validator = Source::template default_validator_type>
 struct InputDesc
 {
@@ -123,76 +153,548 @@ struct InputDesc
 	using source_type = Source;
 	using validator_type = Validator<T>;
 	
-	template <typename RequestType>
-	opt_value_type operator()(const RequestType& req) const
+	template <typename Context>
+	opt_value_type operator()(Context& ctx) const
 	{
 		validator_type validator{};
 		source_type readSource{};
-		return validator(readSource(req));
+		if constexpr (std::is_invocable_v<validator_type&, std::string_view, Context&>) {
+			return validator(readSource(ctx), ctx);
+		} else {
+			return validator(readSource(ctx));
+		}
 	}
 };
 
+/**
+ * Observer policy : hooks notified of each phase of a request, e.g. to open tracing spans or
+ * fire probes around them. Every hook is optional and takes the request first :
+ *   on_request_start(req)
+ *   on_input_validated<I>(req, bool valid), after the Ith input, the last one if it is invalid,
+ *     also invalid when the server's body checker rejects the body the Ith input reads
+ *   on_body_received(req), when the inputs read from the header were validated before the body was received
+ *   on_handler_done(req), once the handler returned its response
+ *   on_serialized(req, MetricsClock::duration), the time the response took to serialize within the handler
+ * A handler's observer is shared by its concurrent requests, so its hooks must be const. An
+ * observer keeping per-request state declares a request_observer_type instead, constructed
+ * from the const observer at the start of each request, whose hooks are called in its place
+ * (see MetricsObserver). Hooks an observer doesn't declare cost nothing, and NoObserver
+ * declares none.
+ */
+struct NoObserver {};
+
 namespace detail
 {
-	template <typename Output, typename ... Inputs, typename RequestType, typename Handler, std::size_t ... Is>
-	auto invokeHandlerImpl(const RequestType& req, Handler&& handler, std::index_sequence<Is...>) -> typename RequestAdapter<RequestType>::response_type
+	template <typename RequestType, typename Output>
+	using response_type_t = typename RequestAdapter<RequestType>::template make_response_type<typename Output::serializer_type>::response_type;
+	
+	// The checker of the first body input whose validator names one.
+	template <typename ... Inputs>
+	struct inputsBodyChecker
+	{
+		using type = NoBodyChecker;
+	};
+	template <typename Input, typename ... Inputs>
+	struct inputsBodyChecker<Input, Inputs...>
+	{
+		using input_checker_type = std::conditional_t<
+			std::is_same_v<typename Input::source_type, BodyParam>,
+			typename bodyCheckerOf<typename Input::validator_type>::type,
+			NoBodyChecker
+		>;
+		using type = std::conditional_t<
+			std::is_same_v<input_checker_type, NoBodyChecker>,
+			typename inputsBodyChecker<Inputs...>::type,
+			input_checker_type
+		>;
+	};
+	
+	// The index of the input inputsBodyChecker picks the checker of, to which its rejections are attributed.
+	template <typename ... Inputs>
+	constexpr std::size_t bodyCheckerInput()
+	{
+		constexpr bool checked[] = {
+			(std::is_same_v<typename Inputs::source_type, BodyParam> && !std::is_same_v<typename bodyCheckerOf<typename Inputs::validator_type>::type, NoBodyChecker>)...,
+			false
+		};
+		std::size_t input = 0;
+		while (input < sizeof...(Inputs) && !checked[input]) {
+			++input;
+		}
+		return input;
+	}
+	
+	template <typename ... Lists>
+	struct concatHeaderKeys
+	{
+		using type = HeaderKeyList<>;
+	};
+	template <typename ... Keys>
+	struct concatHeaderKeys<HeaderKeyList<Keys...>>
+	{
+		using type = HeaderKeyList<Keys...>;
+	};
+	template <typename ... Keys, typename ... Others, typename ... Lists>
+	struct concatHeaderKeys<HeaderKeyList<Keys...>, HeaderKeyList<Others...>, Lists...>
+	{
+		using type = typename concatHeaderKeys<HeaderKeyList<Keys..., Others...>, Lists...>::type;
+	};
+	
+	template <typename Source>
+	struct sourceHeaderKeys
+	{
+		using type = HeaderKeyList<>;
+	};
+	template <typename Key>
+	struct sourceHeaderKeys<HeaderParam<Key>>
+	{
+		using type = HeaderKeyList<Key>;
+	};
+	
+	// The keys of all the HeaderParam inputs, resolved together before the inputs are validated.
+	template <typename ... Inputs>
+	using header_keys_t = typename concatHeaderKeys<typename sourceHeaderKeys<typename Inputs::source_type>::type...>::type;
+	
+	// Names an input's source in its metrics.
+	template <typename Source>
+	std::string describeSource(const Source&)
+	{
+		return "custom";
+	}
+	template <typename Key>
+	std::string describeSource(const HeaderParam<Key>&)
+	{
+		return "header:" + std::string{headerKey<Key>.name};
+	}
+	inline std::string describeSource(const PathParam&)
+	{
+		return "path";
+	}
+	inline std::string describeSource(const QueryStringParam&)
+	{
+		return "query";
+	}
+	inline std::string describeSource(const VerbParam&)
+	{
+		return "verb";
+	}
+	inline std::string describeSource(const BodyParam&)
+	{
+		return "body";
+	}
+	
+	// Inputs which don't read the body can be validated as soon as the header is received.
+	enum class InputPhase
+	{
+		header,
+		body,
+		all,
+	};
+	
+	template <InputPhase Phase, typename Input>
+	constexpr bool inputInPhase = Phase == InputPhase::all || (Phase == InputPhase::body) == std::is_same_v<typename Input::source_type, BodyParam>;
+	
+	// Whether at most one input reads the body, which may then be parsed in place.
+	template <typename ... Inputs>
+	constexpr bool exclusiveBody = ((std::is_same_v<typename Inputs::source_type, BodyParam> ? 1 : 0) + ... + 0) <= 1;
+	
+	template <typename Observer, typename RequestType, typename = void>
+	struct observesRequestStart : std::false_type {};
+	template <typename Observer, typename RequestType>
+	struct observesRequestStart<Observer, RequestType, std::void_t<decltype(std::declval<Observer&>().on_request_start(std::declval<const RequestType&>()))>> : std::true_type {};
+	
+	template <typename Observer, typename RequestType, typename = void>
+	struct observesInputs : std::false_type {};
+	template <typename Observer, typename RequestType>
+	struct observesInputs<Observer, RequestType, std::void_t<decltype(std::declval<Observer&>().template on_input_validated<0>(std::declval<const RequestType&>(), true))>> : std::true_type {};
+	
+	template <typename Observer, typename RequestType, typename = void>
+	struct observesBodyReceived : std::false_type {};
+	template <typename Observer, typename RequestType>
+	struct observesBodyReceived<Observer, RequestType, std::void_t<decltype(std::declval<Observer&>().on_body_received(std::declval<const RequestType&>()))>> : std::true_type {};
+	
+	template <typename Observer, typename RequestType, typename = void>
+	struct observesHandlerDone : std::false_type {};
+	template <typename Observer, typename RequestType>
+	struct observesHandlerDone<Observer, RequestType, std::void_t<decltype(std::declval<Observer&>().on_handler_done(std::declval<const RequestType&>()))>> : std::true_type {};
+	
+	template <typename Observer, typename RequestType, typename = void>
+	struct observesSerialization : std::false_type {};
+	template <typename Observer, typename RequestType>
+	struct observesSerialization<Observer, RequestType, std::void_t<decltype(std::declval<Observer&>().on_serialized(std::declval<const RequestType&>(), MetricsClock::duration{}))>> : std::true_type {};
+	
+	// The hooks of a request are called on the request observer of the policy if it declares one,
+	// on the shared observer otherwise.
+	template <typename Observer, typename = void>
+	struct requestObserver
+	{
+		using type = const Observer&;
+	};
+	template <typename Observer>
+	struct requestObserver<Observer, std::void_t<typename Observer::request_observer_type>>
+	{
+		using type = typename Observer::request_observer_type;
+	};
+	template <typename Observer>
+	using request_observer_t = typename requestObserver<Observer>::type;
+	
+	// Hooks only declared non-const would never be called on the shared observer.
+	template <typename Observer, typename RequestType>
+	constexpr bool hasNonConstHooks =
+		(observesRequestStart<Observer, RequestType>::value && !observesRequestStart<const Observer, RequestType>::value) ||
+		(observesInputs<Observer, RequestType>::value && !observesInputs<const Observer, RequestType>::value) ||
+		(observesBodyReceived<Observer, RequestType>::value && !observesBodyReceived<const Observer, RequestType>::value) ||
+		(observesHandlerDone<Observer, RequestType>::value && !observesHandlerDone<const Observer, RequestType>::value) ||
+		(observesSerialization<Observer, RequestType>::value && !observesSerialization<const Observer, RequestType>::value);
+	
+	template <typename Observer, typename RequestType>
+	void notifyRequestStart(Observer& observer, const RequestType& req)
+	{
+		if constexpr (observesRequestStart<Observer, RequestType>::value) {
+			observer.on_request_start(req);
+		}
+	}
+	
+	// Returns the validated input, to be tested by the caller.
+	template <std::size_t I, typename Observer, typename RequestType, typename Param>
+	const Param& notifyInputValidated(Observer& observer, const RequestType& req, const Param& param)
+	{
+		if constexpr (observesInputs<Observer, RequestType>::value) {
+			observer.template on_input_validated<I>(req, param.has_value());
+		}
+		return param;
+	}
+	
+	// Validates the inputs of the phase into params, up to the first invalid one.
+	template <InputPhase Phase, typename ... Inputs, typename RequestType, typename Observer, typename Params, std::size_t ... Is>
+	bool validateInputs(RequestContext<RequestType>& ctx, Observer& observer, Params& params, std::index_sequence<Is...>)
+	{
+		return ([&] {
+			if constexpr (inputInPhase<Phase, Inputs>) {
+				return notifyInputValidated<Is>(observer, ctx.request(), std::get<Is>(params) = Inputs{}(ctx)).has_value();
+			} else {
+				return true;
+			}
+		}() && ...);
+	}
+	
+	// The validated values are not used past this call, the handler may take them over.
+	template <typename Output, typename RequestType, typename Handler, typename Observer, typename Params, std::size_t ... Is>
+	auto invokeValidated(const RequestType& req, Handler&& handler, Observer& observer, Params& params, std::index_sequence<Is...>) -> detail::response_type_t<RequestType, Output>
 	{
 		using serializer_type = typename Output::serializer_type;
 		using make_response_type = typename RequestAdapter<RequestType>::template make_response_type<serializer_type>;
-		static_assert(sizeof...(Inputs) == sizeof...(Is));
 		
-		std::tuple<std::optional<typename Inputs::value_type>...> params;
-		if (((std::get<Is>(params) = Inputs{}(req)) && ...)) {
+		if constexpr (observesSerialization<Observer, RequestType>::value || observesHandlerDone<Observer, RequestType>::value) {
+			MetricsClock::duration serialization{};
+			auto response = [&] {
+				std::optional<detail::SerializationScope> scope;
+				if constexpr (observesSerialization<Observer, RequestType>::value) {
+					scope.emplace(serialization);
+				}
+				return std::invoke(
+					handler,
+					make_response_type{req},
+					std::move(*std::get<Is>(params))...
+				);
+			}();
+			if constexpr (observesHandlerDone<Observer, RequestType>::value) {
+				observer.on_handler_done(req);
+			}
+			if constexpr (observesSerialization<Observer, RequestType>::value) {
+				observer.on_serialized(req, serialization);
+			}
+			return response;
+		} else {
 			return std::invoke(
 				handler,
 				make_response_type{req},
-				(*std::get<Is>(params))...
+				std::move(*std::get<Is>(params))...
 			);
+		}
+	}
+	
+	// Hooks the observer doesn't declare are not called, so that NoObserver adds no code at all.
+	template <typename Output, typename ... Inputs, typename RequestType, typename Handler, typename Observer, std::size_t ... Is>
+	auto invokeHandlerImpl(RequestContext<RequestType>& ctx, Handler&& handler, Observer& observer, std::index_sequence<Is...> indices) -> detail::response_type_t<RequestType, Output>
+	{
+		using make_response_type = typename RequestAdapter<RequestType>::template make_response_type<typename Output::serializer_type>;
+		static_assert(sizeof...(Inputs) == sizeof...(Is));
+		
+		const RequestType& req = ctx.request();
+		notifyRequestStart(observer, req);
+		ctx.resolveHeaders(header_keys_t<Inputs...>{});
+		std::tuple<std::optional<typename Inputs::value_type>...> params;
+		if (validateInputs<InputPhase::all, Inputs...>(ctx, observer, params, indices)) {
+			return invokeValidated<Output>(req, handler, observer, params, indices);
 		} else {
 			return make_response_type{req}(RequestAdapter<RequestType>::BadRequest);
 		}
 	}
 	
-	template <typename Output, typename ... Inputs, typename RequestType, typename Handler>
-	auto invokeHandler(const RequestType& req, Handler&& handler) -> typename RequestAdapter<RequestType>::response_type
+	template <typename Output, typename ... Inputs, typename RequestType, typename Handler, typename Observer>
+	auto invokeHandler(const RequestType& req, Handler&& handler, Observer& observer) -> detail::response_type_t<RequestType, Output>
 	{
+		RequestContext<RequestType> ctx{req};
 		return invokeHandlerImpl<Output, Inputs...>(
-			req,
+			ctx,
+			std::forward<Handler>(handler),
+			observer,
+			std::index_sequence_for<Inputs...>{}
+		);
+	}
+	
+	// A mutable request lets in-situ validators parse the body in place, provided no other input reads it.
+	template <typename Output, typename ... Inputs, typename RequestType, typename Handler, typename Observer>
+	auto invokeHandler(RequestType& req, Handler&& handler, Observer& observer) -> detail::response_type_t<RequestType, Output>
+	{
+		RequestContext<RequestType> ctx{req, exclusiveBody<Inputs...>};
+		return invokeHandlerImpl<Output, Inputs...>(
+			ctx,
 			std::forward<Handler>(handler),
+			observer,
 			std::index_sequence_for<Inputs...>{}
 		);
 	}
+	
+	// What a handler keeps of a request between the validation of its header and the reception of its
+	// body : the context the inputs were validated in, the values of those read from the header, and
+	// the observer of the request. The headers the inputs read are resolved as soon as it is created.
+	template <typename RequestType, typename Observer, typename ... Inputs>
+	struct PendingRequest
+	{
+		PendingRequest(RequestType& req, const Observer& observer)
+		: ctx{req, exclusiveBody<Inputs...>}
+		, observer{observer}
+		{
+			ctx.setPending();
+			ctx.resolveHeaders(header_keys_t<Inputs...>{});
+		}
+		
+		// The body of a const request is never parsed in place.
+		PendingRequest(const RequestType& req, const Observer& observer)
+		: ctx{req}
+		, observer{observer}
+		{
+			ctx.setPending();
+			ctx.resolveHeaders(header_keys_t<Inputs...>{});
+		}
+		
+		RequestContext<RequestType> ctx;
+		std::tuple<std::optional<typename Inputs::value_type>...> params;
+		request_observer_t<Observer> observer;
+	};
 }
 
 template <typename Output, typename ... Inputs, typename RequestType, typename Handler>
-auto handleRequest(const RequestType& req, Handler&& handler) -> typename RequestAdapter<RequestType>::response_type
+auto handleRequest(const RequestType& req, Handler&& handler) -> detail::response_type_t<RequestType, Output>
 {
+	NoObserver observer;
 	return detail::invokeHandler<Output, Inputs...>(
 		req,
-		std::forward<Handler>(handler)
+		std::forward<Handler>(handler),
+		observer
 	);
 }
 
-template <typename RequestType, typename Output, typename ... Inputs>
-struct RequestHandler
+template <typename Output, typename ... Inputs, typename RequestType, typename Handler>
+auto handleRequest(RequestType& req, Handler&& handler) -> detail::response_type_t<RequestType, Output>
+{
+	NoObserver observer;
+	return detail::invokeHandler<Output, Inputs...>(
+		req,
+		std::forward<Handler>(handler),
+		observer
+	);
+}
+
+template <typename Output, typename ... Inputs, typename RequestType, typename Handler, typename Observer>
+auto handleRequest(const RequestType& req, Handler&& handler, Observer& observer) -> detail::response_type_t<RequestType, Output>
+{
+	return detail::invokeHandler<Output, Inputs...>(
+		req,
+		std::forward<Handler>(handler),
+		observer
+	);
+}
+
+template <typename Output, typename ... Inputs, typename RequestType, typename Handler, typename Observer>
+auto handleRequest(RequestType& req, Handler&& handler, Observer& observer) -> detail::response_type_t<RequestType, Output>
+{
+	return detail::invokeHandler<Output, Inputs...>(
+		req,
+		std::forward<Handler>(handler),
+		observer
+	);
+}
+
+/**
+ * Holds the handler as its own type rather than behind a std::function, so that validating
+ * the inputs, invoking the handler and building the response can all be inlined together.
+ * The handler is usually a lambda, see makeRequestHandler. The observer is notified of the
+ * phases of every request, see NoObserver.
+ */
+template <typename RequestType, typename Handler, typename Observer, typename Output, typename ... Inputs>
+struct BasicRequestHandler
 {
 	using request_adapter = RequestAdapter<RequestType>;
 	using serializer_type = typename Output::serializer_type;
-	using response_type = typename request_adapter::response_type;
 	using make_response_type = typename request_adapter::template make_response_type<serializer_type>;
-	using handler_type = std::function<response_type(make_response_type, typename Inputs::value_type...)>;
+	using response_type = typename make_response_type::response_type;
+	using handler_type = Handler;
+	using observer_type = Observer;
+	using input_types = std::tuple<Inputs...>;
+	using body_checker_type = typename detail::inputsBodyChecker<Inputs...>::type;
+	using pending_request_type = detail::PendingRequest<RequestType, Observer, Inputs...>;
 	
-	RequestHandler(handler_type&& handler) : handler(std::forward<handler_type>(handler)) {}
+	static_assert(
+		!std::is_reference_v<detail::request_observer_t<observer_type>> || !detail::hasNonConstHooks<observer_type, RequestType>,
+		"Observer hooks are called on the observer shared by concurrent requests : declare them const, or declare a request_observer_type."
+	);
+	
+	BasicRequestHandler(handler_type&& handler, observer_type observer = {})
+	: handler(std::forward<handler_type>(handler))
+	, observer(std::move(observer))
+	{}
+	
+	// Fed with the body while it is received, so that the server can reject it before it is complete.
+	body_checker_type bodyChecker(const RequestType&) const
+	{
+		return body_checker_type{};
+	}
+	
+	// Validates the inputs read from the header of req, before its body is received. Their values
+	// are kept in pending along with the context of req, and the handler is invoked with it once the
+	// body is received. Returns the status req must be rejected with when one of them is invalid.
+	std::optional<typename request_adapter::status_type> validateHeaders(RequestType& req, std::optional<pending_request_type>& pending) const
+	{
+		pending.emplace(req, observer);
+		return validatePendingHeaders(pending);
+	}
+	
+	// Same as validateHeaders, for a pending request the caller created, e.g. to read a cache key from its context.
+	std::optional<typename request_adapter::status_type> validatePendingHeaders(std::optional<pending_request_type>& pending) const
+	{
+		auto& current = *pending;
+		detail::notifyRequestStart(current.observer, current.ctx.request());
+		if (detail::validateInputs<detail::InputPhase::header, Inputs...>(current.ctx, current.observer, current.params, std::index_sequence_for<Inputs...>{})) {
+			return std::nullopt;
+		}
+		pending.reset();
+		return request_adapter::BadRequest;
+	}
 	
 	response_type operator()(const RequestType& req) const
 	{
+		return invoke(req);
+	}
+	
+	response_type operator()(RequestType& req) const
+	{
+		return invoke(req);
+	}
+	
+	// Validates the inputs read from the body of req, the others were validated by validateHeaders.
+	response_type operator()(const RequestType& req, pending_request_type& pending) const
+	{
+		notifyBodyReceived(req, pending);
+		if (detail::validateInputs<detail::InputPhase::body, Inputs...>(pending.ctx, pending.observer, pending.params, std::index_sequence_for<Inputs...>{})) {
+			return detail::invokeValidated<Output>(req, handler, pending.observer, pending.params, std::index_sequence_for<Inputs...>{});
+		}
+		return make_response_type{req}(request_adapter::BadRequest);
+	}
+	
+	// Notifies the observer that the body checker rejected req, as the body input it checks.
+	void rejectBody(const RequestType& req, pending_request_type& pending) const
+	{
+		using request_observer_type = std::remove_reference_t<decltype(pending.observer)>;
+		if constexpr (!std::is_same_v<body_checker_type, NoBodyChecker> && detail::observesInputs<request_observer_type, RequestType>::value) {
+			notifyBodyReceived(req, pending);
+			pending.observer.template on_input_validated<detail::bodyCheckerInput<Inputs...>()>(req, false);
+		}
+	}
+	
+	// Records the requests of this handler and of its later copies under name, see Metrics.hpp.
+	// Only handlers observed by MetricsObserver record metrics.
+	template <typename O = observer_type, typename = std::void_t<decltype(std::declval<O&>().enable(std::declval<HandlerMetrics&>()))>>
+	void enableMetrics(std::string_view name, MetricsRegistry& registry = MetricsRegistry::global())
+	{
+		observer.enable(registry.handler(name, {detail::describeSource(typename Inputs::source_type{})...}));
+	}
+	
+	handler_type handler;
+	observer_type observer;
+	
+private:
+	static void notifyBodyReceived(const RequestType& req, pending_request_type& pending)
+	{
+		if constexpr (detail::observesBodyReceived<std::remove_reference_t<decltype(pending.observer)>, RequestType>::value) {
+			pending.observer.on_body_received(req);
+		}
+	}
+	
+	template <typename Request>
+	response_type invoke(Request& req) const
+	{
+		detail::request_observer_t<observer_type> requestObserver{observer};
 		return detail::invokeHandler<Output, Inputs...>(
 			req,
-			handler
+			handler,
+			requestObserver
 		);
 	}
-	
-	handler_type handler;
+};
+
+template <typename RequestType, typename Handler, typename Output, typename ... Inputs>
+using InlineRequestHandler = BasicRequestHandler<RequestType, Handler, NoObserver, Output, Inputs...>;
+
+// Deduces the handler's type, e.g. makeRequestHandler<RequestType, OutputDesc<std::string>, InputDesc<int, BodyParam>>([](auto send, int value) { ... }).
+template <typename RequestType, typename Output, typename ... Inputs, typename Handler>
+InlineRequestHandler<RequestType, std::decay_t<Handler>, Output, Inputs...> makeRequestHandler(Handler&& handler)
+{
+	return InlineRequestHandler<RequestType, std::decay_t<Handler>, Output, Inputs...>{std::decay_t<Handler>{std::forward<Handler>(handler)}};
+}
+
+// Same as above, notifying observer of the phases of every request.
+template <typename RequestType, typename Output, typename ... Inputs, typename Handler, typename Observer>
+BasicRequestHandler<RequestType, std::decay_t<Handler>, std::decay_t<Observer>, Output, Inputs...> makeRequestHandler(Handler&& handler, Observer&& observer)
+{
+	return BasicRequestHandler<RequestType, std::decay_t<Handler>, std::decay_t<Observer>, Output, Inputs...>{
+		std::decay_t<Handler>{std::forward<Handler>(handler)},
+		std::forward<Observer>(observer)
+	};
+}
+
+// Answers with the metrics of registry in the Prometheus text format, to be routed to e.g. GET /metrics.
+template <typename RequestType>
+auto makeMetricsHandler(const MetricsRegistry& registry = MetricsRegistry::global())
+{
+	return makeRequestHandler<RequestType, OutputDesc<std::string>>([&registry](auto makeResponse) {
+		return makeResponse(renderPrometheusMetrics(registry));
+	});
+}
+
+namespace detail
+{
+	template <typename RequestType, typename Output, typename ... Inputs>
+	using erased_handler_t = std::function<response_type_t<RequestType, Output>(
+		typename RequestAdapter<RequestType>::template make_response_type<typename Output::serializer_type>,
+		typename Inputs::value_type...
+	)>;
+}
+
+// Type-erased handler, so that handlers with the same inputs and output share a type.
+template <typename RequestType, typename Output, typename ... Inputs>
+struct RequestHandler : InlineRequestHandler<RequestType, detail::erased_handler_t<RequestType, Output, Inputs...>, Output, Inputs...>
+{
+	using InlineRequestHandler<RequestType, detail::erased_handler_t<RequestType, Output, Inputs...>, Output, Inputs...>::BasicRequestHandler;
+};
+
+// Type-erased handler notifying an Observer of the phases of every request.
+template <typename RequestType, typename Observer, typename Output, typename ... Inputs>
+struct ObservedRequestHandler : BasicRequestHandler<RequestType, detail::erased_handler_t<RequestType, Output, Inputs...>, Observer, Output, Inputs...>
+{
+	using BasicRequestHandler<RequestType, detail::erased_handler_t<RequestType, Output, Inputs...>, Observer, Output, Inputs...>::BasicRequestHandler;
 };
 
 #endif
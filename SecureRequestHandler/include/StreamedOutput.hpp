@@ -0,0 +1,227 @@
+#ifndef STREAMED_OUTPUT_HPP
+#define STREAMED_OUTPUT_HPP
+
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+/**
+ * A body produced in bounded batches while it is being sent, rather than serialized whole
+ * before the first byte goes out.
+ *
+ * The source is either a range, or a generator returning a std::optional which is empty
+ * once it is exhausted. Each element is appended with the element serializer's append
+ * overload. Serializers may frame the elements with stream_prefix, stream_separator and
+ * stream_suffix static members (the JSON serializers produce an array), elements are
+ * written one per line otherwise.
+ *
+ * A source may refer to the request and to the values validated from it (e.g. arena
+ * allocated ones): BeastServer keeps them alive until the whole body is produced.
+ */
+
+// Elements are serialized until a batch reaches this size, then the batch is sent.
+constexpr std::size_t streamedBatchSize = 16 * 1024;
+
+template <typename ElementSerializer>
+struct StreamedSerializer
+{
+	using element_serializer_type = ElementSerializer;
+	using value_type = typename ElementSerializer::value_type;
+};
+
+namespace detail
+{
+	template <typename T>
+	struct isStreamedSerializer : std::false_type {};
+	template <typename ElementSerializer>
+	struct isStreamedSerializer<StreamedSerializer<ElementSerializer>> : std::true_type {};
+
+	template <typename Serializer, typename = void>
+	struct streamFraming
+	{
+		constexpr static std::string_view prefix{};
+		constexpr static std::string_view separator{"\n"};
+		constexpr static std::string_view suffix{"\n"};
+	};
+	template <typename Serializer>
+	struct streamFraming<Serializer, std::void_t<decltype(Serializer::stream_prefix), decltype(Serializer::stream_separator), decltype(Serializer::stream_suffix)>>
+	{
+		constexpr static std::string_view prefix{Serializer::stream_prefix};
+		constexpr static std::string_view separator{Serializer::stream_separator};
+		constexpr static std::string_view suffix{Serializer::stream_suffix};
+	};
+
+	template <typename T>
+	T& unwrapRange(T& range)
+	{
+		return range;
+	}
+	template <typename T>
+	T& unwrapRange(std::reference_wrapper<T> range)
+	{
+		return range.get();
+	}
+
+	// Ranges are owned, unless they are passed with std::ref or std::cref.
+	template <typename Range>
+	class RangeCursor
+	{
+	public:
+		explicit RangeCursor(Range range) : range{std::move(range)} {}
+
+		// Invokes onElement with the next element, returns false once the range is exhausted.
+		template <typename OnElement>
+		bool next(OnElement&& onElement)
+		{
+			if (!it) {
+				it.emplace(std::begin(unwrapRange(range)));
+			}
+			if (*it == std::end(unwrapRange(range))) {
+				return false;
+			}
+			onElement(**it);
+			++*it;
+			return true;
+		}
+
+	private:
+		Range range;
+		std::optional<decltype(std::begin(unwrapRange(std::declval<Range&>())))> it;
+	};
+
+	template <typename Generator>
+	class GeneratorCursor
+	{
+	public:
+		explicit GeneratorCursor(Generator generator) : generator{std::move(generator)} {}
+
+		template <typename OnElement>
+		bool next(OnElement&& onElement)
+		{
+			auto element = generator();
+			if (!element) {
+				return false;
+			}
+			onElement(*element);
+			return true;
+		}
+
+	private:
+		Generator generator;
+	};
+
+	template <typename Source, typename = void>
+	struct cursor
+	{
+		using type = RangeCursor<Source>;
+	};
+	template <typename Source>
+	struct cursor<Source, std::enable_if_t<std::is_invocable_v<Source&>>>
+	{
+		using type = GeneratorCursor<Source>;
+	};
+
+	template <typename Source>
+	using cursor_type = typename cursor<Source>::type;
+
+	template <typename Serializer, typename Cursor>
+	class StreamedSource
+	{
+	public:
+		explicit StreamedSource(Cursor cursor) : cursor{std::move(cursor)} {}
+
+		bool produce(std::string& out)
+		{
+			using framing = streamFraming<Serializer>;
+			if (!started) {
+				started = true;
+				out.append(framing::prefix);
+			}
+			while (out.size() < streamedBatchSize) {
+				const bool more = cursor.next([&](const auto& element) {
+					if (!first) {
+						out.append(framing::separator);
+					}
+					first = false;
+					Serializer{}(element, out);
+				});
+				if (!more) {
+					out.append(framing::suffix);
+					return false;
+				}
+			}
+			return true;
+		}
+
+	private:
+		Cursor cursor;
+		bool started = false;
+		bool first = true;
+	};
+}
+
+// Type-erased source of a streamed body, owning the range or generator it reads.
+class StreamedBody
+{
+public:
+	template <typename ElementSerializer, typename Source>
+	static StreamedBody make(Source&& source)
+	{
+		static_assert(std::is_invocable_v<const ElementSerializer&, const typename ElementSerializer::value_type&, std::string&>, "Streaming requires a serializer with an append overload.");
+		using source_type = detail::StreamedSource<ElementSerializer, detail::cursor_type<std::decay_t<Source>>>;
+		auto state = std::make_unique<source_type>(detail::cursor_type<std::decay_t<Source>>{std::forward<Source>(source)});
+		return StreamedBody{
+			erased_ptr{state.release(), [](void* p) {
+				delete static_cast<source_type*>(p);
+			}},
+			[](void* p, std::string& out) {
+				return static_cast<source_type*>(p)->produce(out);
+			}
+		};
+	}
+
+	// A body already serialized, produced as a single batch.
+	static StreamedBody make(std::string body)
+	{
+		auto state = std::make_unique<std::string>(std::move(body));
+		return StreamedBody{
+			erased_ptr{state.release(), [](void* p) {
+				delete static_cast<std::string*>(p);
+			}},
+			[](void* p, std::string& out) {
+				auto& body = *static_cast<std::string*>(p);
+				if (out.empty()) {
+					out.swap(body);
+				} else {
+					out.append(body);
+				}
+				return false;
+			}
+		};
+	}
+
+	// Appends the next batch to out, returns false once the last batch was produced.
+	bool produce(std::string& out)
+	{
+		return producer(state.get(), out);
+	}
+
+private:
+	using erased_ptr = std::unique_ptr<void, void (*)(void*)>;
+
+	StreamedBody(erased_ptr state, bool (*producer)(void*, std::string&))
+	: state{std::move(state)}
+	, producer{producer}
+	{}
+
+	erased_ptr state;
+	bool (*producer)(void*, std::string&);
+};
+
+#endif